@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cstring>
+#include "arena.hpp"
+
+namespace Prog1 {
+    void *StringArena::do_allocate(std::size_t bytes, std::size_t alignment){
+        while (current < blocks.size()){
+            Block &b = blocks[current];
+            std::size_t start = (offset + alignment - 1) / alignment * alignment;
+            if (start + bytes <= b.size){
+                offset = start + bytes;
+                total += bytes;
+                return b.data.get() + start;
+            }
+            current++;
+            offset = 0;
+        }
+        // new[] выравнивает по max_align_t, этого хватает для любых строк и указателей
+        std::size_t size = std::max(block, bytes);
+        blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+        fresh++;
+        current = blocks.size() - 1;
+        offset = bytes;
+        total += bytes;
+        return blocks.back().data.get();
+    }
+
+    const char *StringArena::copy(std::string_view s){
+        char *p = static_cast<char *>(allocate(s.size() + 1, 1));
+        memcpy(p, s.data(), s.size());
+        p[s.size()] = '\0';
+        return p;
+    }
+
+    const char **StringArena::strings(std::size_t n){
+        const char **p = static_cast<const char **>(allocate(n * sizeof(const char *), alignof(const char *)));
+        std::fill(p, p + n, nullptr);
+        return p;
+    }
+
+    void StringArena::reset(){
+        current = 0;
+        offset = 0;
+        fresh = 0;
+        total = 0;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef OOPPROG1_ARENA_H
+#define OOPPROG1_ARENA_H
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+namespace Prog1 {
+    // область памяти с выделением сдвигом указателя: всё, что выделено за ход,
+    // освобождается разом через reset, а блоки остаются для следующего хода.
+    // Годится и как memory_resource для pmr-контейнеров
+    class StringArena : public std::pmr::memory_resource {
+    public:
+        explicit StringArena(std::size_t block = 64 * 1024) : block(block) {}
+        StringArena(const StringArena &) = delete;
+        StringArena &operator=(const StringArena &) = delete;
+
+        // копия строки с завершающим нулём
+        const char *copy(std::string_view s);
+        // обнулённый массив из n указателей на строки
+        const char **strings(std::size_t n);
+
+        // забывает всё выделенное, блоки переиспользуются
+        void reset();
+        // сколько раз с последнего reset память бралась у системы
+        std::size_t allocations() const { return fresh; }
+        // сколько байтов выдано с последнего reset
+        std::size_t used() const { return total; }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    private:
+        struct Block {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        std::size_t block;
+        std::vector<Block> blocks;
+        std::size_t current = 0; ///< блок, из которого идёт выделение
+        std::size_t offset = 0;
+        std::size_t fresh = 0;
+        std::size_t total = 0;
+    };
+}
+#endif //OOPPROG1_ARENA_H
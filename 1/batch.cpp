@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include "batch.hpp"
+#include "prog.hpp"
+
+namespace Prog1 {
+    std::vector<std::string_view> game_batch(const std::vector<std::vector<std::string>> &histories,
+        const CityDictionary &dict, unsigned threads, BatchStats *stats){
+        constexpr std::size_t CHUNK = 256;
+        auto start = std::chrono::steady_clock::now();
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<std::size_t>(threads, std::max<std::size_t>(1, (histories.size() + CHUNK - 1) / CHUNK));
+
+        std::vector<std::string_view> res(histories.size());
+        std::atomic<std::size_t> next = 0;
+        std::atomic<std::size_t> unanswered = 0;
+        std::exception_ptr error;
+        std::atomic_flag failed;
+
+        auto worker = [&]{
+            // множество названных городов одно на поток и очищается между позициями
+            UsedSet used(dict);
+            std::size_t missed = 0;
+            try {
+                for (std::size_t begin; (begin = next.fetch_add(CHUNK)) < histories.size();){
+                    std::size_t end = std::min(begin + CHUNK, histories.size());
+                    for (std::size_t i = begin; i < end; i++){
+                        const std::vector<std::string> &h = histories[i];
+                        if (h.empty() || h.back().empty()){
+                            missed++;
+                            continue;
+                        }
+                        used.clear();
+                        used.sync(h);
+                        std::uint32_t id = reply(used, h.back());
+                        if (id == CityDictionary::npos)
+                            missed++;
+                        else
+                            res[i] = dict.name(id);
+                    }
+                }
+            } catch(...) {
+                if (!failed.test_and_set())
+                    error = std::current_exception();
+                next = histories.size();
+            }
+            unanswered += missed;
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; i++)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread &t : pool)
+            t.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        if (stats != nullptr){
+            stats->positions = histories.size();
+            stats->unanswered = unanswered;
+            stats->threads = threads;
+            stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return res;
+    }
+}
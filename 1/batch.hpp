@@ -0,0 +1,26 @@
+#ifndef OOPPROG1_BATCH_H
+#define OOPPROG1_BATCH_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "dict.hpp"
+namespace Prog1 {
+    // статистика пакетного разбора позиций
+    struct BatchStats {
+        std::size_t positions = 0;
+        std::size_t unanswered = 0; ///< позиции, в которых ответа нет
+        unsigned threads = 0;
+        double seconds = 0;
+
+        double per_second() const { return seconds > 0 ? positions / seconds : 0; }
+    };
+
+    // ответы на N позиций разом: словарь и его индекс общие для всех потоков,
+    // позиции делятся между потоками порциями. Ответ - string_view внутрь
+    // словаря; пустой, если в позиции ответа нет.
+    // threads == 0 - по числу ядер
+    std::vector<std::string_view> game_batch(const std::vector<std::vector<std::string>> &histories,
+        const CityDictionary &dict, unsigned threads = 0, BatchStats *stats = nullptr);
+}
+#endif //OOPPROG1_BATCH_H
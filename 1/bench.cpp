@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "prog.hpp"
+using namespace Prog1;
+
+// замер game на синтетических словарях от 10^3 городов и историях трёх видов:
+//   short       - несколько случайных ходов
+//   long        - тысяча случайных ходов
+//   adversarial - названа вся корзина нужной буквы, кроме одного города,
+//                 который лежит в самом её начале
+// Для каждой перегрузки печатает ns и выделения памяти на один ход.
+// Прочитанных байт нет: словарь отображён через mmap, read() его не читает,
+// а страницы касаются уже при построении историй
+
+namespace {
+    std::atomic<std::size_t> allocations{0};
+}
+
+void *operator new(std::size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // n разных названий: заглавная буква, потом строчные
+    void generate_dictionary(const std::string &filename, std::size_t n, std::mt19937_64 &rng){
+        std::ofstream out(filename, std::ios::trunc);
+        if (!out.is_open()){
+            throw std::runtime_error("Error in open file");
+        }
+        std::unordered_set<std::string> names;
+        std::string s;
+        while (names.size() < n){
+            s.assign(1, 'A' + rng() % 26);
+            for (std::size_t len = 3 + rng() % 10; s.size() < len;)
+                s += 'a' + rng() % 26;
+            if (names.insert(s).second)
+                out << s << '\n';
+        }
+        if (!out){
+            throw std::runtime_error("Error in write file");
+        }
+    }
+
+    std::vector<std::string> random_history(const CityDictionary &dict, std::size_t moves, std::mt19937_64 &rng){
+        std::vector<std::string> history;
+        for (std::size_t i = 0; i < std::min(moves, dict.size()); i++)
+            history.emplace_back(dict.name(rng() % dict.size()));
+        return history;
+    }
+
+    // худший случай для поиска с конца корзины
+    std::vector<std::string> adversarial_history(const CityDictionary &dict){
+        Letter l = 1;
+        for (Letter k = 1; k < LETTERS; k++){
+            auto [first, last] = dict.bucket(k);
+            auto [bf, bl] = dict.bucket(l);
+            if (last - first > bl - bf)
+                l = k;
+        }
+        auto [first, last] = dict.bucket(l);
+        std::vector<std::string> history;
+        for (std::uint32_t id = first + 1; id < last; id++)
+            history.emplace_back(dict.name(id));
+        // последний ход ведёт на букву l; город из корзины l не годится:
+        // first должен остаться ответом, остальные уже названы
+        for (std::uint32_t id = 0; id < dict.size(); id++){
+            if (dict.letters(id).last == l && (id < first || id >= last)){
+                history.emplace_back(dict.name(id));
+                return history;
+            }
+        }
+        // такого города нет: ход не из словаря, названия здесь латинские
+        history.emplace_back(std::string("Zz") + char(LETTER_CASES[l].lower));
+        return history;
+    }
+
+    // гоняет turn, пока не наберётся времени на устойчивый замер
+    template<class F>
+    void measure(std::size_t size, const char *kind, const char *overload, F turn){
+        turn(); // прогрев: первый ход синхронизирует UsedSet
+        std::size_t allocs = allocations.load(), turns = 0;
+        Clock::time_point start = Clock::now();
+        double elapsed = 0;
+        while (turns < 3 || elapsed < 0.2){
+            turn();
+            turns++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        std::size_t count = allocations.load() - allocs;
+        std::printf("%10zu %-12s %-22s %12.1f %10.2f\n", size, kind, overload,
+                    elapsed * 1e9 / turns, double(count) / turns);
+    }
+
+    void bench(const CityDictionary &dict, const char *kind, const std::vector<std::string> &history){
+        std::vector<const char *> ptrs;
+        for (const std::string &city : history)
+            ptrs.push_back(city.c_str());
+        ptrs.push_back(nullptr);
+
+        measure(dict.size(), kind, "const char**", [&]{
+            delete[] game(ptrs.data(), dict);
+        });
+        measure(dict.size(), kind, "std::string", [&]{
+            game(history, dict);
+        });
+        UsedSet used(dict), used_str(dict);
+        measure(dict.size(), kind, "const char**, UsedSet", [&]{
+            delete[] game(ptrs.data(), used);
+        });
+        measure(dict.size(), kind, "std::string, UsedSet", [&]{
+            game(history, used_str);
+        });
+    }
+}
+
+// bench [наибольший размер словаря, до 10^7] [каталог для словарей]
+int main(int argc, char **argv) {
+    std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string dir = argc > 2 ? argv[2] : ".";
+    try {
+        std::mt19937_64 rng(42);
+        std::printf("%10s %-12s %-22s %12s %10s\n", "cities", "history", "overload", "ns/turn", "allocs");
+        for (std::size_t size = 1000; size <= std::min<std::size_t>(max_size, 10000000); size *= 10){
+            std::string filename = dir + "/bench_" + std::to_string(size) + ".txt";
+            generate_dictionary(filename, size, rng);
+            {
+                CityDictionary dict(filename);
+                bench(dict, "short", random_history(dict, 8, rng));
+                bench(dict, "long", random_history(dict, 1000, rng));
+                bench(dict, "adversarial", adversarial_history(dict));
+            }
+            std::remove(filename.c_str());
+        }
+    }
+    catch(const std::bad_alloc& ba) {
+        std::cerr << "Not enough memory" << std::endl;
+        return 1;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -3,68 +3,33 @@
 #include <iostream>
 #include <string>
 #include "prog.hpp"
+#include "arena.hpp"
+#include "word.hpp"
 using namespace Prog1;
 
 
 void chr_dia(){
-    const char * evil = "1234567890!@#{}$%^&*()[]/\\|=+ ";
+    // вся память хода - из одной области, блоки живут между ходами;
+    // слово читается в буфер ввода и копируется сразу в область
+    static StringArena arena;
+    static std::string word;
+    arena.reset();
     std::cout << "Input number of cities" << std::endl;
-    int b = get<int>();
-    char **inp = new char*[b+1]{}; 
-    bool fl = 0;
+    int b = get<int>(0);
+    const char **inp = arena.strings(b+1);
     for (int i=0; i<b; i++){
-        std::string buf;
-        std::cin >> buf;
-        if (std::cin.eof()){
-            for (int j=0;j<i;j++){
-                char *& c =inp[j];
-                delete[] c;
-            }
-            char **& tmp = inp;
-            delete[] tmp;
-            throw std::runtime_error("Failed to read: EOF");
-        }
-        else if (std::cin.bad()){
-            for (int j=0;j<i;j++){
-                char *& c =inp[j];
-                delete[] c;
-            }
-            char **& tmp = inp;
-            delete[] tmp;
-            throw std::runtime_error(std::string("Failed to read: ") + strerror(errno));
-        }
-        for (int j = 0; j< 30;j++){
-            int test = buf.contains(evil[j]);
-            if (test != 0){
-                fl = 1;
-                std::cout << "Evil character found! Repeat please" << std::endl;
-                break;
-            }
-        }
-        if (fl){
+        std::string_view buf = get_word(word);
+        if (!valid_word(buf)){
+            std::cout << "Evil character found! Repeat please" << std::endl;
             i--;
-            fl = 0;
             continue;
         }
-        inp[i] = new char[buf.length()+1];
-        strcpy(inp[i], buf.c_str());
-    }
-    const char * res;
-    try {                
-        res = game((const char **) inp);
-    } catch(...) {
-        for (int i = 0; i<b;i++){
-          delete[] inp[i];
-        }
-        delete[] inp;
-        throw;
-    }
-    printf("Result: %s\n", res);
-    for (int i = 0; i<b;i++){
-        delete[] inp[i];
+        inp[i] = arena.copy(buf);
     }
-    delete[] inp;
-    delete[] res;
+    UsedSet used(default_dictionary(), &arena);
+    std::string_view res = game_view(inp, used);
+    printf("Result: %.*s\n", (int)res.size(), res.data());
+    printf("Arena blocks: %zu\n", arena.allocations());
 }
 
 void string_dia(){
@@ -72,28 +37,12 @@ void string_dia(){
     std::cout << "Input number of cities" << std::endl;
     int b = get<int>();
     std::vector<std::string> inp(b);
-    int fl = 0;
     for (int i=0; i<b; i++){
         std::string & buf = inp[i];
-        std::cin >> buf;
-        if (std::cin.eof()){
-            throw std::runtime_error("Failed to read: EOF");
-        }
-        else if (std::cin.bad()){
-            throw std::runtime_error(std::string("Failed to read: ") + strerror(errno));
-        }
-        for (int j = 0; j< 30;j++){
-            const char * evil = "1234567890!@#{}$%^&*()[]/\\|=+ ";
-            int test = buf.contains(evil[j]);
-            if (test != 0){
-                fl = 1;
-                std::cout << "Evil character found! Repeat please" << std::endl;
-                break;
-            }
-        }
-        if (fl){
+        buf = get_word();
+        if (!valid_word(buf)){
+            std::cout << "Evil character found! Repeat please" << std::endl;
             i--;
-            fl = 0;
             continue;
         }
     }
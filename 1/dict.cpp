@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dict.hpp"
+
+namespace Prog1 {
+namespace {
+    constexpr char MAGIC[8] = {'C', 'I', 'T', 'Y', 'D', 'I', 'C', 'T'};
+    constexpr std::uint32_t VERSION = 4;
+    constexpr std::size_t PAIRS = LETTERS * LETTERS;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t letters;
+        std::uint32_t count;
+        std::uint32_t table_size;
+        std::uint64_t names_size;
+    };
+
+    std::uint32_t fnv1a(std::string_view s){
+        std::uint32_t h = 2166136261u;
+        for (char c : s){
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // размер хеш-таблицы: степень двойки, заполнение не больше половины
+    std::uint32_t table_size(std::size_t n){
+        std::uint32_t size = 2;
+        while (size < 2 * n)
+            size *= 2;
+        return size;
+    }
+}
+
+    CityDictionary::CityDictionary(const std::string &filename, FileMode mode) : file(filename, mode){
+        if (file.size() >= sizeof(MAGIC) && memcmp(file.data(), MAGIC, sizeof(MAGIC)) == 0)
+            load_compiled();
+        else
+            load_text();
+    }
+
+    void CityDictionary::load_compiled(){
+        Header h;
+        if (file.size() < sizeof(h)){
+            throw std::runtime_error("Broken dictionary header");
+        }
+        memcpy(&h, file.data(), sizeof(h));
+        if (h.version != VERSION || h.letters != LETTERS){
+            throw std::runtime_error("Unsupported dictionary version");
+        }
+        std::uint64_t expected = sizeof(h) + (PAIRS + 1) * sizeof(std::uint32_t)
+            + std::uint64_t(h.count) * (sizeof(Entry) + sizeof(std::uint32_t))
+            + std::uint64_t(h.table_size) * sizeof(std::uint32_t) + h.names_size;
+        if (expected != file.size() || h.table_size == 0 || (h.table_size & (h.table_size - 1)) != 0){
+            throw std::runtime_error("Broken dictionary header");
+        }
+        const char *p = file.data() + sizeof(h);
+        offsets = reinterpret_cast<const std::uint32_t *>(p);
+        p += (PAIRS + 1) * sizeof(std::uint32_t);
+        entries = reinterpret_cast<const Entry *>(p);
+        p += std::size_t(h.count) * sizeof(Entry);
+        pairs = reinterpret_cast<const std::uint32_t *>(p);
+        p += std::size_t(h.count) * sizeof(std::uint32_t);
+        table = reinterpret_cast<const std::uint32_t *>(p);
+        p += std::size_t(h.table_size) * sizeof(std::uint32_t);
+        base = p;
+        count = h.count;
+        mask = h.table_size - 1;
+        // файл нужного размера ещё может быть испорчен внутри: проверяем всё,
+        // по чему потом индексируем, чтобы name() и bucket() не вышли за файл
+        if (offsets[0] != 0 || offsets[PAIRS] != count){
+            throw std::runtime_error("Broken dictionary header");
+        }
+        for (std::size_t i = 0; i < PAIRS; i++){
+            if (offsets[i] > offsets[i + 1]){
+                throw std::runtime_error("Broken dictionary offsets");
+            }
+        }
+        for (std::uint32_t id = 0; id < count; id++){
+            const Entry &e = entries[id];
+            if (std::uint64_t(e.offset) + e.length > h.names_size
+                || e.letters.first >= LETTERS || e.letters.last >= LETTERS || e.letters.prelast >= LETTERS){
+                throw std::runtime_error("Broken dictionary entry");
+            }
+        }
+        for (std::uint32_t pos = 0; pos < count; pos++){
+            if (pairs[pos] >= count){
+                throw std::runtime_error("Broken dictionary pairs");
+            }
+        }
+        // поиск идёт до пустой ячейки, поэтому хотя бы одна должна быть
+        std::uint32_t used = 0;
+        for (std::uint32_t i = 0; i <= mask; i++){
+            if (table[i] != npos && (table[i] >= count || ++used > mask)){
+                throw std::runtime_error("Broken dictionary table");
+            }
+        }
+    }
+
+    void CityDictionary::load_text(){
+        std::string_view text = file.view();
+        base = text.data();
+        own_table.assign(table_size(std::count(text.begin(), text.end(), '\n') + 1), npos);
+        mask = own_table.size() - 1;
+
+        // строки остаются в отображённом файле, запоминаются только смещения;
+        // в хеш-таблицу пока кладётся номер строки
+        std::vector<Entry> lines;
+        while (!text.empty()){
+            std::size_t end = text.find('\n');
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            // пустые строки и повторы пропускаем
+            if (line.empty())
+                continue;
+            std::uint32_t i = fnv1a(line) & mask;
+            bool fresh = true;
+            for (; own_table[i] != npos; i = (i + 1) & mask){
+                const Entry &e = lines[own_table[i]];
+                if (line == std::string_view(base + e.offset, e.length)){
+                    fresh = false;
+                    break;
+                }
+            }
+            if (!fresh)
+                continue;
+            own_table[i] = lines.size();
+            lines.push_back({std::uint32_t(line.data() - base), std::uint32_t(line.size()), letters_of(line)});
+        }
+
+        // сортировка подсчётом: идентификаторы - по первой букве, позиции
+        // в own_pairs - по паре (первая, последняя буква); порядок файла
+        // внутри корзины и внутри пары сохраняется
+        auto pair_of = [](const Entry &e){
+            return e.letters.first * LETTERS + e.letters.last;
+        };
+        std::vector<std::uint32_t> pos(PAIRS + 1);
+        for (const Entry &e : lines)
+            pos[pair_of(e) + 1]++;
+        for (std::size_t k = 0; k < PAIRS; k++)
+            pos[k + 1] += pos[k];
+        own_offsets = pos;
+        // корзина буквы начинается там же, где её первая пара
+        std::vector<std::uint32_t> next(LETTERS);
+        for (std::size_t l = 0; l < LETTERS; l++)
+            next[l] = own_offsets[l * LETTERS];
+        own_entries.resize(lines.size());
+        std::vector<std::uint32_t> ids(lines.size());
+        for (std::size_t i = 0; i < lines.size(); i++){
+            ids[i] = next[lines[i].letters.first]++;
+            own_entries[ids[i]] = lines[i];
+        }
+        own_pairs.resize(lines.size());
+        for (std::uint32_t id = 0; id < own_entries.size(); id++)
+            own_pairs[pos[pair_of(own_entries[id])]++] = id;
+        for (std::uint32_t &slot : own_table){
+            if (slot != npos)
+                slot = ids[slot];
+        }
+
+        entries = own_entries.data();
+        offsets = own_offsets.data();
+        pairs = own_pairs.data();
+        table = own_table.data();
+        count = own_entries.size();
+    }
+
+    std::uint32_t CityDictionary::find(std::string_view city) const{
+        for (std::uint32_t i = fnv1a(city) & mask; table[i] != npos; i = (i + 1) & mask){
+            if (name(table[i]) == city)
+                return table[i];
+        }
+        return npos;
+    }
+
+    std::size_t CityDictionary::memory() const{
+        return sizeof(*this) + file.size() + own_entries.capacity() * sizeof(Entry)
+            + (own_offsets.capacity() + own_pairs.capacity() + own_table.capacity()) * sizeof(std::uint32_t);
+    }
+
+    void CityDictionary::save(const std::string &filename) const{
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()){
+            throw std::runtime_error("Error in open file");
+        }
+        // названия идут подряд, перед каждым - его длина
+        std::vector<Entry> packed(count);
+        std::uint64_t names_size = 0;
+        for (std::uint32_t id = 0; id < count; id++){
+            names_size += sizeof(std::uint32_t);
+            packed[id] = {std::uint32_t(names_size), entries[id].length, entries[id].letters};
+            names_size += entries[id].length;
+            if (names_size > UINT32_MAX){
+                throw std::runtime_error("Dictionary is too large");
+            }
+        }
+
+        Header h{};
+        memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.letters = LETTERS;
+        h.count = count;
+        h.table_size = mask + 1;
+        h.names_size = names_size;
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char *>(offsets), (PAIRS + 1) * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char *>(packed.data()), packed.size() * sizeof(Entry));
+        out.write(reinterpret_cast<const char *>(pairs), std::size_t(count) * sizeof(std::uint32_t));
+        out.write(reinterpret_cast<const char *>(table), std::size_t(mask + 1) * sizeof(std::uint32_t));
+        for (std::uint32_t id = 0; id < count; id++){
+            std::uint32_t len = entries[id].length;
+            out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+            out.write(base + entries[id].offset, len);
+        }
+        if (!out){
+            throw std::runtime_error("Error in write file");
+        }
+    }
+}
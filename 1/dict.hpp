@@ -0,0 +1,92 @@
+#ifndef OOPPROG1_DICT_H
+#define OOPPROG1_DICT_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "letter.hpp"
+#include "mapped.hpp"
+namespace Prog1 {
+    // словарь городов: загружается один раз, города сгруппированы по первой букве.
+    // Файл отображается в память, названия - это string_view внутрь него.
+    // Понимает текстовый list.txt (город на строку) и скомпилированный
+    // двоичный формат (см. save), который используется без разбора
+    class CityDictionary {
+    public:
+        // диапазон идентификаторов [first, second)
+        using Range = std::pair<std::uint32_t, std::uint32_t>;
+
+        static constexpr std::uint32_t npos = UINT32_MAX;
+
+        // FileMode::copy читает файл в свою память: так словарь переживает
+        // перезапись файла на месте
+        explicit CityDictionary(const std::string &filename, FileMode mode = FileMode::map);
+        CityDictionary(const CityDictionary &) = delete;
+        CityDictionary &operator=(const CityDictionary &) = delete;
+
+        std::size_t size() const { return count; }
+        std::string_view name(std::uint32_t id) const {
+            return {base + entries[id].offset, entries[id].length};
+        }
+        // буквы названия, посчитанные при загрузке
+        Letters letters(std::uint32_t id) const { return entries[id].letters; }
+        // все города на букву l идут подряд в порядке файла
+        Range bucket(Letter l) const { return {offsets[l * LETTERS], offsets[(l + 1) * LETTERS]}; }
+        // города с первой буквой first и последней last - это позиции
+        // [first, second) для by_pair, внутри пары в порядке файла. Пары одной
+        // первой буквы вместе занимают те же номера, что и bucket(first)
+        Range pair_bucket(Letter first, Letter last) const {
+            return {offsets[first * LETTERS + last], offsets[first * LETTERS + last + 1]};
+        }
+        // идентификатор города на позиции pos в порядке пар букв
+        std::uint32_t by_pair(std::uint32_t pos) const { return pairs[pos]; }
+        // матрица переходов: сколько городов ведут с буквы first на букву last
+        std::uint32_t transitions(Letter first, Letter last) const {
+            auto [b, e] = pair_bucket(first, last);
+            return e - b;
+        }
+        // идентификатор города или npos, если его нет в словаре
+        std::uint32_t find(std::string_view city) const;
+        // сколько байт занимают отображённый файл и таблицы
+        std::size_t memory() const;
+        // true, если словарь загружен из двоичного файла
+        bool compiled() const { return entries != own_entries.data(); }
+
+        // записывает словарь в двоичном формате (порядок байт - родной):
+        // заголовок, таблица диапазонов пар букв, записи {смещение, длина, буквы},
+        // идентификаторы в порядке пар букв, хеш-таблица идентификаторов
+        // и названия с префиксом длины
+        void save(const std::string &filename) const;
+
+    private:
+        struct Entry {
+            std::uint32_t offset; ///< смещение названия от base
+            std::uint32_t length;
+            Letters letters;
+            std::uint8_t reserved = 0;
+        };
+
+        void load_text();
+        void load_compiled();
+
+        MappedFile file;
+        const char *base = nullptr;
+        const Entry *entries = nullptr;
+        // начало диапазона пары (первая, последняя буква), LETTERS * LETTERS + 1
+        const std::uint32_t *offsets = nullptr;
+        // идентификаторы, упорядоченные по паре (первая, последняя буква)
+        const std::uint32_t *pairs = nullptr;
+        // открытая адресация по FNV-1a, пустая ячейка - npos
+        const std::uint32_t *table = nullptr;
+        std::uint32_t count = 0;
+        std::uint32_t mask = 0;
+
+        // хранилище для текстового формата; у двоичного всё лежит в файле
+        std::vector<Entry> own_entries;
+        std::vector<std::uint32_t> own_offsets;
+        std::vector<std::uint32_t> own_pairs;
+        std::vector<std::uint32_t> own_table;
+    };
+}
+#endif //OOPPROG1_DICT_H
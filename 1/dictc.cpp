@@ -0,0 +1,25 @@
+#include <iostream>
+#include "dict.hpp"
+using namespace Prog1;
+
+// компилирует текстовый список городов в двоичный словарь
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " list.txt list.bin" << std::endl;
+        return 1;
+    }
+    try {
+        CityDictionary dict(argv[1]);
+        dict.save(argv[2]);
+        std::cout << dict.size() << " cities written to " << argv[2] << std::endl;
+    }
+    catch(const std::bad_alloc& ba) {
+        std::cerr << "Not enough memory" << std::endl;
+        return 1;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
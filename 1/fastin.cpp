@@ -0,0 +1,90 @@
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "fastin.hpp"
+
+namespace Prog1 {
+    ScriptInput *ScriptInput::current = nullptr;
+
+    void ScriptInput::enable(int fd){
+        static ScriptInput in(fd);
+        current = &in;
+    }
+
+    bool ScriptInput::fill(std::size_t keep){
+        std::size_t tail = len - keep;
+        if (keep > 0)
+            memmove(buf.data(), buf.data() + keep, tail);
+        // слово длиннее буфера - буфер растёт
+        if (tail == buf.size())
+            buf.resize(buf.size() * 2);
+        pos -= keep;
+        len = tail;
+        while (true){
+            ssize_t n = read(fd, buf.data() + len, buf.size() - len);
+            if (n > 0){
+                len += n;
+                return true;
+            }
+            if (n == 0)
+                return false;
+            if (errno != EINTR){
+                error = errno;
+                return false;
+            }
+        }
+    }
+
+    bool ScriptInput::word(std::string_view &out){
+        while (true){
+            while (pos < len && isspace(static_cast<unsigned char>(buf[pos])))
+                pos++;
+            if (pos < len)
+                break;
+            if (!fill(len))
+                return false;
+        }
+        std::size_t start = pos;
+        while (true){
+            while (pos < len && !isspace(static_cast<unsigned char>(buf[pos])))
+                pos++;
+            if (pos < len)
+                break;
+            // слово могло оборваться на границе буфера
+            std::size_t shift = start;
+            if (!fill(start)){
+                if (failed())
+                    return false;
+                start -= shift;
+                break;
+            }
+            start -= shift;
+        }
+        out = std::string_view(buf.data() + start, pos - start);
+        return true;
+    }
+
+    std::string_view ScriptInput::get_word(){
+        std::string_view w;
+        if (!word(w)){
+            if (failed())
+                throw std::runtime_error(std::string("Failed to read: ") + strerror(error));
+            throw std::runtime_error("Failed to read: EOF");
+        }
+        return w;
+    }
+
+    void ScriptInput::skip_line(){
+        while (true){
+            const char *nl = static_cast<const char *>(memchr(buf.data() + pos, '\n', len - pos));
+            if (nl != nullptr){
+                pos = nl - buf.data() + 1;
+                return;
+            }
+            pos = len;
+            if (!fill(len))
+                return;
+        }
+    }
+}
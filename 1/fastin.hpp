@@ -0,0 +1,58 @@
+#ifndef OOPPROG1_FASTIN_H
+#define OOPPROG1_FASTIN_H
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+namespace Prog1 {
+    // пакетный ввод для скриптов: читает дескриптор большими блоками
+    // и разбирает числа через std::from_chars, минуя std::cin
+    class ScriptInput {
+    public:
+        // включает пакетный ввод для get и get_word
+        static void enable(int fd = 0);
+        // nullptr, если пакетный ввод не включён
+        static ScriptInput *active() { return current; }
+
+        // следующее слово; view живёт до следующего вызова.
+        // false - конец файла или ошибка чтения (см. failed)
+        bool word(std::string_view &out);
+        // то же, но при конце файла или ошибке чтения бросает исключение, как get
+        std::string_view get_word();
+        // пропускает остаток текущей строки
+        void skip_line();
+        // была ли ошибка чтения (errno сохранён)
+        bool failed() const { return error != 0; }
+
+        // то же, что get, но через буфер
+        template<class T>
+        T get(T min, T max) {
+            while(true) {
+                std::string_view w = get_word();
+                // from_chars не понимает явный плюс, а std::cin понимает
+                if(w.size() > 1 && w.front() == '+' && w[1] != '-')
+                    w.remove_prefix(1);
+                T a;
+                auto [end, ec] = std::from_chars(w.data(), w.data() + w.size(), a);
+                if(ec == std::errc() && end == w.data() + w.size() && !(a < min) && !(a > max))
+                    return a;
+                skip_line();
+                std::cout << "repeat please!\n";
+            }
+        }
+
+    private:
+        explicit ScriptInput(int fd) : fd(fd), buf(1 << 20) {}
+        // дочитывает в буфер, сохраняя непросмотренный хвост с позиции keep
+        bool fill(std::size_t keep);
+
+        static ScriptInput *current;
+        int fd;
+        int error = 0;
+        std::vector<char> buf;
+        std::size_t pos = 0, len = 0;
+    };
+}
+#endif //OOPPROG1_FASTIN_H
@@ -0,0 +1,96 @@
+#ifndef OOPPROG1_LETTER_H
+#define OOPPROG1_LETTER_H
+#include <array>
+#include <cstdint>
+#include <string_view>
+namespace Prog1 {
+    // буква - номер буквы без учёта регистра: 0 - не буква,
+    // 1..26 - латиница, 27..58 - кириллица а..я, 59 - ё
+    using Letter = std::uint8_t;
+    constexpr std::size_t LETTERS = 64;
+    constexpr Letter NOT_LETTER = 0;
+
+    // строчная и заглавная кодовые точки буквы
+    struct LetterCase {
+        char32_t lower;
+        char32_t upper;
+    };
+
+    constexpr std::array<LetterCase, LETTERS> LETTER_CASES = []{
+        std::array<LetterCase, LETTERS> res{};
+        std::size_t l = 1;
+        for (char32_t c = U'a'; c <= U'z'; c++)
+            res[l++] = {c, c - 0x20};
+        for (char32_t c = U'а'; c <= U'я'; c++)
+            res[l++] = {c, c - 0x20};
+        res[l++] = {U'ё', U'Ё'};
+        return res;
+    }();
+
+    // свёртка регистра: кодовая точка U+0000..U+045F -> буква
+    constexpr std::array<Letter, 0x460> CASE_FOLD = []{
+        std::array<Letter, 0x460> res{};
+        for (std::size_t l = 1; l < LETTERS; l++){
+            if (LETTER_CASES[l].lower != 0)
+                res[LETTER_CASES[l].lower] = res[LETTER_CASES[l].upper] = l;
+        }
+        return res;
+    }();
+
+    constexpr Letter letter_of(char32_t c) {
+        return c < CASE_FOLD.size() ? CASE_FOLD[c] : NOT_LETTER;
+    }
+
+    // кодовая точка UTF-8, которая начинается в s[i]; битая - U+FFFD
+    constexpr char32_t decode_at(std::string_view s, std::size_t i) {
+        unsigned char c = s[i];
+        if (c < 0x80)
+            return c;
+        // число байт продолжения; 4 - байт не может начинать кодовую точку
+        std::size_t n = c >= 0xF8 ? 4 : c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 4;
+        if (n == 4 || i + n >= s.size())
+            return U'\uFFFD';
+        char32_t code = c & (0x3F >> n);
+        for (std::size_t k = 1; k <= n; k++){
+            unsigned char t = s[i + k];
+            if ((t & 0xC0) != 0x80)
+                return U'\uFFFD';
+            code = (code << 6) | (t & 0x3F);
+        }
+        return code;
+    }
+
+    // начало кодовой точки, которая заканчивается перед s[end]
+    constexpr std::size_t code_before(std::string_view s, std::size_t end) {
+        std::size_t i = end - 1;
+        while (i > 0 && end - i < 4 && (static_cast<unsigned char>(s[i]) & 0xC0) == 0x80)
+            i--;
+        return i;
+    }
+
+    // первая, последняя и предпоследняя буквы названия;
+    // считаются один раз при загрузке словаря
+    struct Letters {
+        Letter first = NOT_LETTER;
+        Letter last = NOT_LETTER;
+        Letter prelast = NOT_LETTER; ///< NOT_LETTER, если в названии одна кодовая точка
+    };
+
+    constexpr Letters letters_of(std::string_view city) {
+        Letters res;
+        if (city.empty())
+            return res;
+        res.first = letter_of(decode_at(city, 0));
+        std::size_t last = code_before(city, city.size());
+        res.last = letter_of(decode_at(city, last));
+        if (last > 0)
+            res.prelast = letter_of(decode_at(city, code_before(city, last)));
+        return res;
+    }
+
+    static_assert(letters_of("Москва").first == letters_of("мир").first);
+    static_assert(letters_of("Ёлки").first == letter_of(U'ё') && letter_of(U'ё') != letter_of(U'е'));
+    static_assert(letters_of("Рига").last == letters_of("Алма-Ата").last);
+    static_assert(letters_of("Amsterdam").prelast == letter_of(U'A'));
+}
+#endif //OOPPROG1_LETTER_H
@@ -11,9 +11,11 @@ using namespace Prog1;
 //TODO вынести функции диалога в отедельный файл
 
 
-// основная функция
-int main() {
+// основная функция; с ключом --script ввод читается пакетно
+int main(int argc, char **argv) {
     int ch;
+    if (argc > 1 && strcmp(argv[1], "--script") == 0)
+        ScriptInput::enable();
     try {
         while (true){
             std::cout << "1. to use const char *" << std::endl << "2. to use std::string" << std::endl;
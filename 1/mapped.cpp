@@ -0,0 +1,82 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped.hpp"
+
+namespace Prog1 {
+    MappedFile::MappedFile(const std::string &filename, FileMode mode){
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1){
+            throw std::runtime_error("Error in open file");
+        }
+        struct stat st;
+        if (fstat(fd, &st) == -1){
+            close(fd);
+            throw std::runtime_error(std::string("Error in stat file: ") + strerror(errno));
+        }
+        length = st.st_size;
+        if (mode == FileMode::copy){
+            // new[] выравнивает по max_align_t, как и mmap, этого хватает
+            // таблицам двоичного словаря; файл мог укоротиться за время чтения
+            owned.reset(new char[length > 0 ? length : 1]);
+            std::size_t done = 0;
+            while (done < length){
+                ssize_t n = read(fd, owned.get() + done, length - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0){
+                    int err = errno;
+                    close(fd);
+                    throw std::runtime_error(std::string("Error in read file: ") + strerror(err));
+                }
+                if (n == 0)
+                    break;
+                done += n;
+            }
+            close(fd);
+            length = done;
+            addr = owned.get();
+            return;
+        }
+        // пустой файл отобразить нельзя, он просто остаётся пустым
+        if (length > 0){
+            void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED){
+                close(fd);
+                throw std::runtime_error(std::string("Error in mmap file: ") + strerror(errno));
+            }
+            madvise(p, length, MADV_SEQUENTIAL);
+            addr = static_cast<const char *>(p);
+        }
+        close(fd);
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : addr(std::exchange(other.addr, nullptr)), length(std::exchange(other.length, 0)),
+          owned(std::move(other.owned)) {}
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept{
+        if (this != &other){
+            unmap();
+            addr = std::exchange(other.addr, nullptr);
+            length = std::exchange(other.length, 0);
+            owned = std::move(other.owned);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile(){
+        unmap();
+    }
+
+    void MappedFile::unmap(){
+        if (addr != nullptr && owned == nullptr)
+            munmap(const_cast<char *>(addr), length);
+    }
+}
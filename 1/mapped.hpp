@@ -0,0 +1,37 @@
+#ifndef OOPPROG1_MAPPED_H
+#define OOPPROG1_MAPPED_H
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+namespace Prog1 {
+    // как держать содержимое файла
+    enum class FileMode {
+        map,  ///< отображение без копирования; файл нельзя переписывать на месте
+        copy  ///< своя копия в памяти; файл можно менять как угодно
+    };
+
+    // файл, отображённый в память (или прочитанный в неё) только для чтения
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string &filename, FileMode mode = FileMode::map);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        ~MappedFile();
+
+        const char *data() const { return addr; }
+        std::size_t size() const { return length; }
+        std::string_view view() const { return {addr, length}; }
+
+    private:
+        void unmap();
+
+        const char *addr = nullptr;
+        std::size_t length = 0;
+        std::unique_ptr<char[]> owned; ///< данные для FileMode::copy
+    };
+}
+#endif //OOPPROG1_MAPPED_H
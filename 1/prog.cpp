@@ -1,160 +1,187 @@
 #include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 #include "prog.hpp"
-#include <fstream>
 
 namespace Prog1 {
-// функция освобождения занятой памяти
-    const char * game(const char**str){
-        FILE *fd = fopen("../list.txt", "r");
-        if (fd == nullptr){
-            throw std::runtime_error("Error in open file");
-        }
-        int flag = 0;
-        char *buf = nullptr;
-        size_t size = 0;
-        ssize_t a = 0;
-        char last = '\0';
-        char lastlast = '\0';
-        char *laststr = nullptr;
-        char *lastlaststr = nullptr;
-
-        const char *before;
-        const char **tmp = str;
-        while (*tmp != NULL){
-            before = *tmp;
-            tmp++;
+namespace {
+    // последний в корзине буквы l город, который ещё не называли
+    std::uint32_t find_city(const UsedSet &used, Letter l){
+        // тупиковую букву отбрасываем сразу, не просматривая корзину
+        if (l == NOT_LETTER || used.left(l) == 0)
+            return CityDictionary::npos;
+        auto [first, last] = used.dictionary().bucket(l);
+        for (std::uint32_t id = last; id > first; id--){
+            if (!used.contains(id - 1))
+                return id - 1;
         }
+        return CityDictionary::npos;
+    }
 
-        last = before[strlen(before)-1];
-        if (strlen(before) > 1)
-          lastlast = before[strlen(before) - 2];
-        else 
-          lastlast = '\x00';
-        do{
-            a = getline(&buf, &size, fd);
-            size = strlen(buf);
-            buf[size-1] = '\0';
-            if (buf[0]+0x20 == last){
-                tmp = str;
-                while (*tmp != NULL){
-                    //printf("%s %s\n", buf, *tmp);
-                    if (strcmp(buf, *tmp) == 0){
-                        flag = 1;
-                        break;
-                    }
-                    tmp++;
-                }
-                if (flag){
-                    flag = 0;
-                    continue;
-                }
-                delete[] laststr;
-                laststr = new char[strlen(buf)+1];
-                strcpy(laststr, buf);
-                // laststr = buf;
-
-                break;
-            }
-            if (buf[0]+0x20 == lastlast){
-                tmp = str;
-                while (*tmp != NULL){
-                    if (strcmp(buf, *tmp) == 0){
-                        flag = 1;
-                        break;
-                    }
-                    tmp++;
-                }
-                if (flag){
-                    flag = 0;
-                    continue;
-                }
-                delete[] lastlaststr;
-                lastlaststr = new char[strlen(buf)+1];
-                strcpy(lastlaststr, buf);
-                // lastlaststr = buf;
+    // последний по алфавиту неназванный город сжатого словаря на букву l
+    std::uint32_t find_city(const CityTrie &trie, const std::unordered_set<std::uint32_t> &used, Letter l){
+        auto ranges = trie.buckets(l);
+        for (auto r = ranges.rbegin(); r != ranges.rend(); r++){
+            for (std::uint32_t id = r->second; id > r->first; id--){
+                if (!used.contains(id - 1))
+                    return id - 1;
             }
-        }while(a != -1);
-        if (laststr == NULL){
-            if (lastlaststr == NULL){
-                free(buf);
-                fclose(fd);
-                throw std::runtime_error("Couldn't find a city");
+        }
+        return CityTrie::npos;
+    }
+
+    std::string answer(const CityTrie &trie, const std::vector<std::string_view> &history){
+        if (history.empty()){
+            throw std::runtime_error("Empty history");
+        }
+        std::unordered_set<std::uint32_t> used;
+        for (std::string_view city : history){
+            if (city.empty()){
+                throw std::runtime_error("Empty city");
             }
-            free(buf);
-            buf = new char[strlen(lastlaststr)+1];
-            strcpy(buf, lastlaststr);
-        } else {
-            free(buf);
-            buf = new char[strlen(laststr)+1];
-            strcpy(buf, laststr);
+            std::uint32_t id = trie.find(city);
+            if (id != CityTrie::npos)
+                used.insert(id);
+        }
+        Letters before = letters_of(history.back());
+        std::uint32_t id = find_city(trie, used, before.last);
+        if (id == CityTrie::npos)
+            id = find_city(trie, used, before.prelast);
+        if (id == CityTrie::npos){
+            throw std::runtime_error("Couldn't find a city");
+        }
+        return trie.name(id);
+    }
+
+    std::string_view answer(const UsedSet &used, std::string_view before){
+        std::uint32_t id = reply(used, before);
+        if (id == CityDictionary::npos){
+            throw std::runtime_error("Couldn't find a city");
+        }
+        return used.dictionary().name(id);
+    }
+}
+
+    std::uint32_t reply(const UsedSet &used, std::string_view before){
+        if (before.empty()){
+            throw std::runtime_error("Empty city");
+        }
+        Letters l = letters_of(before);
+        std::uint32_t id = find_city(used, l.last);
+        if (id == CityDictionary::npos)
+            id = find_city(used, l.prelast);
+        return id;
+    }
+
+    std::string get_word(){
+        if (ScriptInput *in = ScriptInput::active())
+            return std::string(in->get_word());
+        std::string buf;
+        get_word(buf);
+        return buf;
+    }
+
+    std::string_view get_word(std::string &buf){
+        if (ScriptInput *in = ScriptInput::active())
+            return in->get_word();
+        std::cin >> buf;
+        if (std::cin.eof()){
+            throw std::runtime_error("Failed to read: EOF");
+        }
+        else if (std::cin.bad()){
+            throw std::runtime_error(std::string("Failed to read: ") + strerror(errno));
         }
-        fclose(fd);
-        delete[]lastlaststr;
-        delete[]laststr;
         return buf;
     }
 
+    std::string default_dictionary_path(){
+        // скомпилированный словарь, если он есть, иначе текстовый список
+        return std::filesystem::exists("list.bin") ? "list.bin" : "list.txt";
+    }
+
+    const CityDictionary &default_dictionary(){
+        static const CityDictionary dict(default_dictionary_path());
+        return dict;
+    }
+
+    const char * game(const char**str){
+        return game(str, default_dictionary());
+    }
+
     std::string game(std::vector<std::string> str){
-        std::string filename = "list.txt";
-        std::ifstream fd(filename);
-        if (!fd.is_open()){
-            throw std::runtime_error("Error in open file");
+        return game(str, default_dictionary());
+    }
+
+    const char * game(const char**str, const CityDictionary &dict){
+        if (str == nullptr){
+            throw std::runtime_error("Empty history");
         }
-      
-        std::string tmp = str.back();
-        char last = tmp.back();
-        char lastlast = tmp[tmp.length()-2];
-        bool fl;
-
-        std::string laststr = "";
-        std::string lastlaststr = "";
-
-        std::string line;
-        while (getline(fd, line)){
-          if (line.front()+0x20 == last){
-            fl = 0;
-            for (uint i=0;i<str.size();i++){
-              if (line == str[i]){
-                fl = 1;
-                break;
-              }
-            }
-            if (fl)
-              continue;
-            
-            laststr = line;
-          }
-          if (line.front()+0x20 == lastlast){
-            fl = 0;
-            for (uint i=0;i<str.size();i++){
-              if (line == str[i]){
-                fl = 1;
-                break;
-              }
-            }
-            if (fl)
-              continue;
+        GameSession session(dict);
+        for (; *str != nullptr; str++)
+            session.play(*str);
+        std::string_view res = session.respond();
+        // результат освобождает вызывающий
+        char *buf = new char[res.size() + 1];
+        memcpy(buf, res.data(), res.size());
+        buf[res.size()] = '\0';
+        return buf;
+    }
+
+    std::string game(const std::vector<std::string> &str, const CityDictionary &dict){
+        GameSession session(dict);
+        for (const std::string &city : str)
+            session.play(city);
+        return std::string(session.respond());
+    }
 
-            lastlaststr = line;
-          }
+    const char * game(const char**str, const CityTrie &trie){
+        if (str == nullptr){
+            throw std::runtime_error("Empty history");
         }
-        
-        std::string res;
-        if (laststr.size()==0){
-          if (lastlaststr.size() == 0){
-            fd.close();
-            throw std::runtime_error("Couldn't find a city");
-          }
-            res = lastlaststr;
-        } else {
-            res = laststr;
+        std::vector<std::string_view> history;
+        for (; *str != nullptr; str++)
+            history.emplace_back(*str);
+        std::string res = answer(trie, history);
+        // результат освобождает вызывающий
+        char *buf = new char[res.size() + 1];
+        memcpy(buf, res.data(), res.size() + 1);
+        return buf;
+    }
+
+    std::string game(const std::vector<std::string> &str, const CityTrie &trie){
+        return answer(trie, std::vector<std::string_view>(str.begin(), str.end()));
+    }
+
+    std::string_view game_view(const char**str, UsedSet &used){
+        if (str == nullptr || *str == nullptr){
+            throw std::runtime_error("Empty history");
+        }
+        used.sync(str);
+        const char **tmp = str;
+        while (*(tmp + 1) != nullptr)
+            tmp++;
+        return answer(used, *tmp);
+    }
+
+    const char * game(const char**str, UsedSet &used){
+        std::string_view res = game_view(str, used);
+        // результат освобождает вызывающий
+        char *buf = new char[res.size() + 1];
+        memcpy(buf, res.data(), res.size());
+        buf[res.size()] = '\0';
+        return buf;
+    }
+
+    std::string game(const std::vector<std::string> &str, UsedSet &used){
+        if (str.empty()){
+            throw std::runtime_error("Empty history");
         }
-        
-        fd.close();
-        return res;
+        used.sync(str);
+        return std::string(answer(used, str.back()));
     }
 }
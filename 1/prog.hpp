@@ -5,10 +5,18 @@
 #include <limits>
 #include <cstring>
 #include <vector>
+#include "fastin.hpp"
+#include "dict.hpp"
+#include "used.hpp"
+#include "session.hpp"
+#include "trie.hpp"
 namespace Prog1 {
     // шаблонная функция ввода одного числа
+    // в пакетном режиме (ScriptInput::enable) читает через буфер
     template<class T>
     T get(T min = std::numeric_limits<T>::lowest(), T max = std::numeric_limits<T>::max()) {
+        if(ScriptInput *in = ScriptInput::active())
+            return in->get<T>(min, max);
         T a;
         while(true) {
             std::cin >> a;
@@ -28,7 +36,32 @@ namespace Prog1 {
         }
     }
 
+    // ввод одного слова с теми же ошибками, что и у get
+    std::string get_word();
+    // то же без выделения памяти: view в буфер ScriptInput или в buf,
+    // живёт до следующего чтения; buf переиспользуется между вызовами
+    std::string_view get_word(std::string &buf);
+
+    // словарь list.bin или list.txt, загружается при первом обращении
+    std::string default_dictionary_path();
+    const CityDictionary &default_dictionary();
+
+    // ответ - последний в порядке файла неназванный город на нужную букву
     const char*game(const char**);
     std::string game(std::vector<std::string>);
+    const char*game(const char**, const CityDictionary &);
+    std::string game(const std::vector<std::string> &, const CityDictionary &);
+    // город на последнюю букву before, если такого нет - на предпоследнюю;
+    // npos, если подходящих городов не осталось
+    std::uint32_t reply(const UsedSet &, std::string_view before);
+    // то же, но множество названных городов живёт между ходами одной игры
+    const char*game(const char**, UsedSet &);
+    std::string game(const std::vector<std::string> &, UsedSet &);
+    // то же по сжатому словарю; ответ - последний по алфавиту
+    // неназванный город, поэтому он может отличаться от ответа по CityDictionary
+    const char*game(const char**, const CityTrie &);
+    std::string game(const std::vector<std::string> &, const CityTrie &);
+    // ответ без копирования: view внутрь словаря, освобождать не нужно
+    std::string_view game_view(const char**, UsedSet &);
 }
 #endif //OOPPROG1_PROG1_H
\ No newline at end of file
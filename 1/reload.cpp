@@ -0,0 +1,109 @@
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "reload.hpp"
+
+namespace Prog1 {
+    LiveDictionary::LiveDictionary(std::string filename)
+        : filename(std::move(filename)), snapshot(new Snapshot{std::make_shared<const CityDictionary>(this->filename, FileMode::copy)}) {}
+
+    LiveDictionary::~LiveDictionary(){
+        if (watcher.joinable()){
+            std::uint64_t one = 1;
+            while (write(stop_fd, &one, sizeof(one)) == -1 && errno == EINTR){}
+            watcher.join();
+            close(stop_fd);
+        }
+        delete snapshot.load();
+    }
+
+    std::shared_ptr<const CityDictionary> LiveDictionary::current() const{
+        unsigned e = epoch.load() & 1;
+        readers[e]++;
+        std::shared_ptr<const CityDictionary> res = snapshot.load()->dict;
+        readers[e]--;
+        return res;
+    }
+
+    void LiveDictionary::reload(){
+        // новый индекс строится без блокировки, подмена - одним обменом указателя
+        // снимок читает файл в свою память: отображение упало бы с SIGBUS,
+        // когда файл переписывают на месте, а старые партии ещё читают названия
+        Snapshot *fresh = new Snapshot{std::make_shared<const CityDictionary>(filename, FileMode::copy)};
+        std::lock_guard<std::mutex> lock(writer);
+        Snapshot *old = snapshot.exchange(fresh);
+        // читатель, взявший номер эпохи до подмены, мог ещё не скопировать
+        // старый shared_ptr; дожидаемся обоих счётчиков по очереди
+        for (int i = 0; i < 2; i++){
+            unsigned e = epoch.fetch_add(1) & 1;
+            while (readers[e] != 0)
+                std::this_thread::yield();
+        }
+        // сам словарь освободится, когда его отпустит последняя партия
+        delete old;
+        versions++;
+    }
+
+    void LiveDictionary::watch(){
+        if (watcher.joinable())
+            return;
+        std::filesystem::path path(filename);
+        std::string dir = path.has_parent_path() ? path.parent_path().string() : ".";
+        int inotify = inotify_init1(IN_CLOEXEC);
+        if (inotify == -1){
+            throw std::runtime_error(std::string("Error in inotify: ") + strerror(errno));
+        }
+        // следим за каталогом: редакторы и mv заменяют файл, а не пишут в него
+        if (inotify_add_watch(inotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1){
+            close(inotify);
+            throw std::runtime_error(std::string("Error in inotify: ") + strerror(errno));
+        }
+        stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (stop_fd == -1){
+            close(inotify);
+            throw std::runtime_error(std::string("Error in eventfd: ") + strerror(errno));
+        }
+        watcher = std::thread(&LiveDictionary::run, this, inotify, stop_fd);
+    }
+
+    void LiveDictionary::run(int inotify, int stop){
+        std::string name = std::filesystem::path(filename).filename().string();
+        alignas(inotify_event) char buf[4096];
+        pollfd fds[2] = {{inotify, POLLIN, 0}, {stop, POLLIN, 0}};
+        while (true){
+            if (poll(fds, 2, -1) == -1){
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            if (fds[1].revents != 0)
+                break;
+            ssize_t n = read(inotify, buf, sizeof(buf));
+            if (n <= 0)
+                continue;
+            bool changed = false;
+            for (char *p = buf; p < buf + n;){
+                const inotify_event *ev = reinterpret_cast<const inotify_event *>(p);
+                if (ev->len > 0 && name == ev->name)
+                    changed = true;
+                p += sizeof(inotify_event) + ev->len;
+            }
+            if (!changed)
+                continue;
+            try {
+                reload();
+            }
+            catch(const std::exception& e) {
+                // битый или недописанный файл: играем на старом словаре
+                std::cerr << "Dictionary reload failed: " << e.what() << std::endl;
+            }
+        }
+        close(inotify);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef OOPPROG1_RELOAD_H
+#define OOPPROG1_RELOAD_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "dict.hpp"
+namespace Prog1 {
+    // словарь, который можно подменить на лету. Читатели получают снимок
+    // без блокировок и держат его, пока он нужен: партии и ходы, начатые
+    // на старом снимке, на нём и заканчиваются.
+    // Каждый снимок держит свою копию файла, поэтому файл можно и заменять
+    // (mv), и переписывать на месте. Подменяется только словарь сервера:
+    // свободные game() из prog.hpp играют на default_dictionary()
+    class LiveDictionary {
+    public:
+        explicit LiveDictionary(std::string filename);
+        LiveDictionary(const LiveDictionary &) = delete;
+        LiveDictionary &operator=(const LiveDictionary &) = delete;
+        ~LiveDictionary();
+
+        // текущий снимок; только атомарные операции, без мьютексов
+        std::shared_ptr<const CityDictionary> current() const;
+        // сколько раз словарь подменялся
+        std::uint64_t version() const { return versions; }
+
+        // перечитывает файл и подменяет снимок; если файл не читается,
+        // исключение, а старый снимок остаётся
+        void reload();
+        // следит за файлом через inotify и перечитывает его в фоновом потоке
+        void watch();
+
+    private:
+        struct Snapshot {
+            std::shared_ptr<const CityDictionary> dict;
+        };
+
+        void run(int inotify, int stop);
+
+        std::string filename;
+        std::atomic<Snapshot *> snapshot;
+        // читатели отмечаются в счётчике текущей эпохи; писатель, подменив
+        // снимок, переключает эпоху и ждёт, пока старый счётчик обнулится
+        mutable std::atomic<std::uint64_t> readers[2] = {0, 0};
+        std::atomic<unsigned> epoch = 0;
+        std::atomic<std::uint64_t> versions = 0;
+        std::mutex writer; ///< только между писателями
+        std::thread watcher;
+        int stop_fd = -1;
+    };
+}
+#endif //OOPPROG1_RELOAD_H
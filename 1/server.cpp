@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "prog.hpp"
+#include "reload.hpp"
+#include "session.hpp"
+using namespace Prog1;
+
+// сервер партий: много игр в одном процессе над общим словарём.
+// Запросы - строки "<сессия> <команда> [город]" из stdin или из UNIX-сокета:
+//   move <город>  - ход соперника и ответ сервера
+//   play <город>  - только ход соперника
+//   respond       - только ответ сервера
+//   end           - закончить партию
+// Ответы - строки "<сессия> <город>", "<сессия> ok", "<сессия> lost"
+// или "<сессия> error <текст>". Сессии распределены по потокам по хешу
+// имени, поэтому каждая партия обслуживается одним потоком без блокировок.
+// В режиме сокета партии принадлежат соединению: когда оно закрывается,
+// все названные в нём сессии заканчиваются, как по end.
+// Новая партия берёт текущий снимок словаря; с --watch словарь
+// перечитывается при замене файла, а идущие партии доигрывают на старом.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    volatile std::sig_atomic_t stopping = 0;
+
+    // канал, в который пишутся ответы; пишут несколько потоков
+    class Output {
+    public:
+        explicit Output(int fd, bool owned = false) : fd(fd), owned(owned) {}
+        Output(const Output &) = delete;
+        Output &operator=(const Output &) = delete;
+        ~Output(){
+            if (owned)
+                close(fd);
+        }
+
+        // будит поток, читающий из этого соединения
+        void hang_up(){ shutdown(fd, SHUT_RD); }
+
+        void write(const std::string &line){
+            std::lock_guard<std::mutex> lock(m);
+            for (std::size_t done = 0; done < line.size();){
+                ssize_t n = ::write(fd, line.data() + done, line.size() - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return; // клиент ушёл, ответ некому отдать
+                done += n;
+            }
+        }
+
+    private:
+        int fd;
+        bool owned;
+        std::mutex m;
+    };
+
+    // сигналы остановки получает только главный поток
+    class SignalsBlocked {
+    public:
+        SignalsBlocked(){
+            sigset_t set;
+            sigemptyset(&set);
+            sigaddset(&set, SIGINT);
+            sigaddset(&set, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &set, &old);
+        }
+        ~SignalsBlocked(){ pthread_sigmask(SIG_SETMASK, &old, nullptr); }
+
+    private:
+        sigset_t old;
+    };
+
+    // гистограмма задержек с логарифмическими корзинами (8 на каждую степень
+    // двойки): память постоянная на долго работающем сервере, гистограммы
+    // потоков складываются, квантиль - верхняя граница корзины, точность ~6%
+    class Histogram {
+    public:
+        void add(double us){
+            counts[bucket(us)]++;
+            total++;
+        }
+        void merge(const Histogram &other){
+            for (std::size_t b = 0; b < BUCKETS; b++)
+                counts[b] += other.counts[b];
+            total += other.total;
+        }
+        std::uint64_t size() const { return total; }
+        double quantile(double q) const{
+            std::uint64_t rank = std::max<std::uint64_t>(1, std::ceil(q * total)), seen = 0;
+            for (std::size_t b = 0; b < BUCKETS; b++){
+                seen += counts[b];
+                if (seen >= rank)
+                    return upper(b);
+            }
+            return upper(BUCKETS - 1);
+        }
+
+    private:
+        static constexpr std::size_t SUB = 8, BUCKETS = 40 * SUB;
+
+        // корзины 0..SUB-1 - всё, что быстрее микросекунды
+        static std::size_t bucket(double us){
+            if (!(us >= 1))
+                return 0;
+            int e;
+            double m = std::frexp(us, &e); // us = m * 2^e, m в [0.5, 1)
+            return std::min(BUCKETS - 1, std::size_t(e) * SUB + std::size_t((m - 0.5) * 2 * SUB));
+        }
+        static double upper(std::size_t b){
+            return std::ldexp(0.5 + double(b % SUB + 1) / (2 * SUB), b / SUB);
+        }
+
+        std::array<std::uint64_t, BUCKETS> counts{};
+        std::uint64_t total = 0;
+    };
+
+    struct Request {
+        std::string session;
+        std::string command;
+        std::string city;
+        std::shared_ptr<Output> out; ///< nullptr - служебный запрос без ответа
+        Clock::time_point start;
+    };
+
+    class Worker {
+    public:
+        Worker(const LiveDictionary &dict, Strategy strategy, std::uint64_t seed)
+            : dict(dict), strategy(strategy), seed(seed), thread(&Worker::run, this) {}
+
+        void push(Request r){
+            {
+                std::lock_guard<std::mutex> lock(m);
+                queue.push_back(std::move(r));
+            }
+            cv.notify_one();
+        }
+
+        // дорабатывает очередь и останавливает поток
+        void stop(){
+            {
+                std::lock_guard<std::mutex> lock(m);
+                done = true;
+            }
+            cv.notify_one();
+            thread.join();
+        }
+
+        Histogram latencies; ///< микросекунды на запрос
+
+    private:
+        void run(){
+            while (true){
+                Request r;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    cv.wait(lock, [this]{ return done || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+                    r = std::move(queue.front());
+                    queue.pop_front();
+                }
+                std::string res = handle(r);
+                if (!r.out)
+                    continue;
+                r.out->write(r.session + " " + res + "\n");
+                latencies.add(std::chrono::duration<double, std::micro>(Clock::now() - r.start).count());
+            }
+        }
+
+        std::string handle(const Request &r){
+            auto it = sessions.find(r.session);
+            if (r.command == "end"){
+                if (it != sessions.end())
+                    sessions.erase(it);
+                return "ok";
+            }
+            if (it == sessions.end()){
+                // у каждой сессии свой поток случайных ответов, воспроизводимый по seed
+                std::uint64_t s = seed ^ std::hash<std::string>()(r.session);
+                it = sessions.try_emplace(r.session, dict.current(), strategy, s).first;
+            }
+            GameSession &game = it->second;
+            try {
+                if (r.command == "play" || r.command == "move")
+                    game.play(r.city);
+                if (r.command == "play")
+                    return "ok";
+                if (r.command == "respond" || r.command == "move")
+                    return std::string(game.respond());
+                return "error unknown command";
+            }
+            catch(const std::bad_alloc& ba) {
+                return "error Not enough memory";
+            }
+            catch(const std::exception& e) {
+                if (strcmp(e.what(), "Couldn't find a city") == 0)
+                    return "lost";
+                return std::string("error ") + e.what();
+            }
+        }
+
+        const LiveDictionary &dict;
+        Strategy strategy;
+        std::uint64_t seed;
+        std::unordered_map<std::string, GameSession> sessions;
+        std::mutex m;
+        std::condition_variable cv;
+        std::deque<Request> queue;
+        bool done = false;
+        std::thread thread;
+    };
+
+    class Server {
+    public:
+        Server(const LiveDictionary &dict, Strategy strategy, std::uint64_t seed, unsigned threads){
+            for (unsigned i = 0; i < threads; i++)
+                workers.push_back(std::make_unique<Worker>(dict, strategy, seed));
+        }
+
+        // разбирает строку запроса и отдаёт её потоку сессии;
+        // sessions - открытые партии соединения, если их нужно отслеживать
+        void dispatch(std::string_view line, const std::shared_ptr<Output> &out,
+                      std::unordered_set<std::string> *sessions = nullptr){
+            Clock::time_point start = Clock::now();
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            Request r;
+            r.out = out;
+            r.start = start;
+            std::size_t sp = line.find(' ');
+            r.session = line.substr(0, sp);
+            if (r.session.empty())
+                return;
+            line.remove_prefix(sp == std::string_view::npos ? line.size() : sp + 1);
+            sp = line.find(' ');
+            r.command = line.substr(0, sp);
+            if (sp != std::string_view::npos)
+                r.city = line.substr(sp + 1);
+            if (sessions != nullptr){
+                if (r.command == "end")
+                    sessions->erase(r.session);
+                else
+                    sessions->insert(r.session);
+            }
+            workers[std::hash<std::string>()(r.session) % workers.size()]->push(std::move(r));
+        }
+
+        // заканчивает партии ушедшего соединения, не отвечая на это
+        void drop(const std::unordered_set<std::string> &sessions){
+            for (const std::string &session : sessions){
+                Request r;
+                r.session = session;
+                r.command = "end";
+                workers[std::hash<std::string>()(session) % workers.size()]->push(std::move(r));
+            }
+        }
+
+        // останавливает потоки и печатает задержки
+        void report(){
+            Histogram all;
+            for (auto &w : workers){
+                w->stop();
+                all.merge(w->latencies);
+            }
+            std::cerr << "requests: " << all.size();
+            if (all.size() > 0)
+                std::cerr << " p50: " << all.quantile(0.50) << " us p99: " << all.quantile(0.99) << " us";
+            std::cerr << std::endl;
+        }
+
+    private:
+        std::vector<std::unique_ptr<Worker>> workers;
+    };
+
+    // читает строки из fd, пока он не закроется; false - ошибка чтения
+    bool read_lines(int fd, const std::function<void(std::string_view)> &line){
+        std::string buf;
+        char chunk[1 << 16];
+        while (!stopping){
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+                return false;
+            if (n == 0)
+                break;
+            buf.append(chunk, n);
+            std::size_t begin = 0;
+            for (std::size_t nl; (nl = buf.find('\n', begin)) != std::string::npos; begin = nl + 1)
+                line(std::string_view(buf).substr(begin, nl - begin));
+            buf.erase(0, begin);
+        }
+        if (!buf.empty())
+            line(buf);
+        return true;
+    }
+
+    void serve_socket(Server &server, const std::string &path){
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == -1){
+            throw std::runtime_error(std::string("Error in socket: ") + strerror(errno));
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)){
+            close(listener);
+            throw std::runtime_error("Socket path is too long");
+        }
+        strcpy(addr.sun_path, path.c_str());
+        unlink(path.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 || listen(listener, 128) == -1){
+            close(listener);
+            throw std::runtime_error(std::string("Error in bind: ") + strerror(errno));
+        }
+        // соединение закрывается, когда его поток дочитал, а очереди
+        // ответили на все запросы; сервер держит только слабую ссылку,
+        // чтобы разбудить поток при остановке
+        struct Client {
+            std::weak_ptr<Output> out;
+            std::shared_ptr<std::atomic<bool>> finished;
+            std::thread thread;
+        };
+        std::list<Client> clients;
+        auto reap = [&clients]{
+            for (auto it = clients.begin(); it != clients.end();){
+                if (*it->finished){
+                    it->thread.join();
+                    it = clients.erase(it);
+                }
+                else
+                    ++it;
+            }
+        };
+        while (!stopping){
+            int fd = accept(listener, nullptr, nullptr);
+            reap();
+            if (fd == -1){
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                // кончились дескрипторы или память: ждём, пока закроются другие соединения
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM){
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    continue;
+                }
+                break;
+            }
+            // одно соединение - один поток чтения, партии обслуживают общие потоки
+            auto out = std::make_shared<Output>(fd, true);
+            auto finished = std::make_shared<std::atomic<bool>>(false);
+            SignalsBlocked blocked;
+            clients.push_back({out, finished, std::thread([&server, fd, out, finished]() mutable {
+                // партии живут, пока открыто соединение, в котором они шли:
+                // клиент, ушедший без end, не оставляет их в памяти
+                std::unordered_set<std::string> sessions;
+                read_lines(fd, [&](std::string_view line){ server.dispatch(line, out, &sessions); });
+                server.drop(sessions);
+                out.reset();
+                *finished = true;
+            })});
+        }
+        close(listener);
+        unlink(path.c_str());
+        for (Client &c : clients){
+            if (auto out = c.out.lock())
+                out->hang_up();
+        }
+        for (Client &c : clients)
+            c.thread.join();
+    }
+}
+
+// server [--socket PATH] [--dict FILE] [--threads N] [--greedy | --random SEED] [--watch]
+int main(int argc, char **argv) {
+    std::string socket_path, dict_path;
+    bool watch = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    Strategy strategy = Strategy::last;
+    std::uint64_t seed = 0;
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (arg == "--dict" && i + 1 < argc)
+            dict_path = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, atoi(argv[++i]));
+        else if (arg == "--greedy")
+            strategy = Strategy::greedy;
+        else if (arg == "--random" && i + 1 < argc){
+            strategy = Strategy::random;
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--watch")
+            watch = true;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--socket PATH] [--dict FILE] [--threads N] [--greedy | --random SEED] [--watch]" << std::endl;
+            return 1;
+        }
+    }
+
+    // без SA_RESTART: сигнал прерывает accept и read
+    struct sigaction sa{};
+    sa.sa_handler = [](int){ stopping = 1; };
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        LiveDictionary dict(dict_path.empty() ? default_dictionary_path() : dict_path);
+        std::unique_ptr<Server> started;
+        {
+            SignalsBlocked blocked;
+            if (watch)
+                dict.watch();
+            started = std::make_unique<Server>(dict, strategy, seed, threads);
+        }
+        Server &server = *started;
+        if (socket_path.empty()){
+            auto out = std::make_shared<Output>(STDOUT_FILENO);
+            read_lines(STDIN_FILENO, [&](std::string_view line){ server.dispatch(line, out); });
+        }
+        else
+            serve_socket(server, socket_path);
+        server.report();
+    }
+    catch(const std::bad_alloc& ba) {
+        std::cerr << "Not enough memory" << std::endl;
+        return 1;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
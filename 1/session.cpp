@@ -0,0 +1,119 @@
+#include <stdexcept>
+#include <string>
+#include "session.hpp"
+
+namespace Prog1 {
+    void GameSession::play(std::string_view city){
+        if (city.empty()){
+            throw std::runtime_error("Empty city");
+        }
+        // города не из словаря не могут быть ответом, их не запоминаем
+        std::uint32_t id = dictionary().find(city);
+        if (id != CityDictionary::npos)
+            name(id);
+        last_move = id != CityDictionary::npos ? dictionary().letters(id) : letters_of(city);
+        moves.emplace_back(city);
+    }
+
+    void GameSession::seed_random(std::uint64_t seed){
+        if (strategy == Strategy::random)
+            rng = std::make_unique<std::mt19937_64>(seed);
+    }
+
+    void GameSession::name(std::uint32_t id){
+        if (used.contains(id))
+            return;
+        used.add(id);
+        if (strategy != Strategy::random)
+            return;
+        // обмен с последним неназванным и укорачивание пула
+        Pool &p = pool(dictionary().letters(id).first);
+        auto at = [&p](std::uint32_t k){
+            auto it = p.at.find(k);
+            return it == p.at.end() ? p.first + k : it->second;
+        };
+        auto it = p.pos.find(id);
+        std::uint32_t k = it == p.pos.end() ? id - p.first : it->second;
+        std::uint32_t last = at(--p.size);
+        p.at[k] = last;
+        p.pos[last] = k;
+        p.at.erase(p.size);
+        p.pos.erase(id);
+    }
+
+    GameSession::Pool &GameSession::pool(Letter l){
+        auto [it, fresh] = pools.try_emplace(l);
+        if (fresh){
+            CityDictionary::Range range = dictionary().bucket(l);
+            it->second.first = range.first;
+            it->second.size = range.second - range.first;
+        }
+        return it->second;
+    }
+
+    std::uint32_t GameSession::find_random(Letter l){
+        Pool &p = pool(l);
+        std::uint32_t k = std::uniform_int_distribution<std::uint32_t>(0, p.size - 1)(*rng);
+        auto it = p.at.find(k);
+        return it == p.at.end() ? p.first + k : it->second;
+    }
+
+    std::uint32_t GameSession::find_in(CityDictionary::Range range, std::uint32_t &top, bool paired) const{
+        auto id = [&](std::uint32_t pos){ return paired ? dictionary().by_pair(pos) : pos; };
+        while (top > range.first && used.contains(id(top - 1)))
+            top--;
+        return top > range.first ? id(top - 1) : CityDictionary::npos;
+    }
+
+    std::uint32_t GameSession::find(Letter l){
+        if (l == NOT_LETTER || used.left(l) == 0)
+            return CityDictionary::npos;
+        if (strategy == Strategy::greedy)
+            return find_greedy(l);
+        if (strategy == Strategy::random)
+            return find_random(l);
+        CityDictionary::Range range = dictionary().bucket(l);
+        return find_in(range, tops.try_emplace(l, range.second).first->second);
+    }
+
+    std::uint32_t GameSession::find_greedy(Letter l){
+        // по матрице переходов выбираем последнюю букву ответа, после которой
+        // у соперника меньше всего неназванных городов; корзины не просматриваются.
+        // Если на последнюю букву ответа ничего не осталось (ь, ы или не буква),
+        // соперник продолжает по предпоследней, а её матрица не хранит.
+        // Такие ответы не тупик, поэтому берём их, только когда других нет
+        std::uint32_t best = UINT32_MAX;
+        Letter best_last = NOT_LETTER;
+        for (std::size_t last = NOT_LETTER + 1; last < LETTERS; last++){
+            if (used.left(l, last) == 0)
+                continue;
+            std::uint32_t options = used.left(last) - (last == l ? 1 : 0);
+            if (options > 0 && options < best){
+                best = options;
+                best_last = last;
+            }
+            else if (options == 0 && best == UINT32_MAX && best_last == NOT_LETTER){
+                best_last = last;
+            }
+        }
+        CityDictionary::Range range = dictionary().pair_bucket(l, best_last);
+        return find_in(range, pair_tops.try_emplace(l * LETTERS + best_last, range.second).first->second, true);
+    }
+
+    std::string_view GameSession::respond(){
+        if (moves.empty()){
+            throw std::runtime_error("Empty history");
+        }
+        std::uint32_t id = find(last_move.last);
+        if (id == CityDictionary::npos)
+            id = find(last_move.prelast);
+        if (id == CityDictionary::npos){
+            throw std::runtime_error("Couldn't find a city");
+        }
+        std::string_view res = dictionary().name(id);
+        name(id);
+        last_move = dictionary().letters(id);
+        moves.emplace_back(res);
+        return res;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef OOPPROG1_SESSION_H
+#define OOPPROG1_SESSION_H
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "dict.hpp"
+#include "used.hpp"
+namespace Prog1 {
+    // как выбирать ответ среди подходящих городов
+    enum class Strategy {
+        last,  ///< последний неназванный город корзины, как в game
+        greedy, ///< город, после которого у соперника меньше всего ответов
+        random  ///< равновероятный неназванный город, O(1) на ход
+    };
+
+    // одна партия: хранит историю и названные города, ходы подаются по одному
+    class GameSession {
+    public:
+        // seed задаёт случайные ответы Strategy::random: одинаковые seed
+        // и ходы соперника дают одинаковую партию
+        explicit GameSession(const CityDictionary &dict, Strategy strategy = Strategy::last, std::uint64_t seed = 0)
+            : used(dict), strategy(strategy) { seed_random(seed); }
+        // партия держит снимок словаря, пока не закончится
+        explicit GameSession(std::shared_ptr<const CityDictionary> dict, Strategy strategy = Strategy::last,
+                             std::uint64_t seed = 0)
+            : keep(std::move(dict)), used(*keep), strategy(strategy) { seed_random(seed); }
+
+        const CityDictionary &dictionary() const { return used.dictionary(); }
+        const std::vector<std::string> &history() const { return moves; }
+
+        // ход соперника
+        void play(std::string_view city);
+        // ответ на последний ход; он тоже записывается в историю.
+        // Время не зависит от длины партии (амортизированно O(1))
+        std::string_view respond();
+
+    private:
+        std::uint32_t find(Letter l);
+        std::uint32_t find_greedy(Letter l);
+        std::uint32_t find_random(Letter l);
+        void seed_random(std::uint64_t seed);
+        // отмечает названный город: в множестве и, для random, в пуле буквы
+        void name(std::uint32_t id);
+        // последний неназванный город диапазона; top - курсор диапазона.
+        // paired - диапазон позиций CityDictionary::by_pair, а не идентификаторов
+        std::uint32_t find_in(CityDictionary::Range range, std::uint32_t &top, bool paired = false) const;
+
+        std::shared_ptr<const CityDictionary> keep;
+        UsedSet used;
+        Strategy strategy;
+        std::vector<std::string> moves;
+        Letters last_move; ///< буквы последнего хода
+        // для буквы (пары букв): все города диапазона с идентификатором >= top уже названы
+        std::unordered_map<Letter, std::uint32_t> tops;
+        std::unordered_map<std::uint32_t, std::uint32_t> pair_tops;
+
+        // неназванные города корзины буквы - перестановка её идентификаторов,
+        // из которой удаляют обменом с последним. Хранятся только отличия
+        // от тождественной перестановки, поэтому память растёт с числом ходов
+        struct Pool {
+            std::uint32_t first;  ///< начало корзины
+            std::uint32_t size;   ///< сколько городов ещё не названо
+            std::unordered_map<std::uint32_t, std::uint32_t> at;  ///< позиция -> город
+            std::unordered_map<std::uint32_t, std::uint32_t> pos; ///< город -> позиция
+        };
+        Pool &pool(Letter l);
+        std::unordered_map<Letter, Pool> pools;
+        std::unique_ptr<std::mt19937_64> rng; ///< только для Strategy::random
+    };
+}
+#endif //OOPPROG1_SESSION_H
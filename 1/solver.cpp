@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "solver.hpp"
+#include "used.hpp"
+
+namespace Prog1 {
+namespace {
+    // города с одинаковыми первой, последней и предпоследней буквами
+    // взаимозаменяемы, поэтому перебор идёт по таким классам
+    struct Class {
+        Letter first;
+        Letter last;
+        Letter prelast; ///< NOT_LETTER, если у города одна буква
+    };
+
+    Class class_of(Letters l){
+        return {l.first, l.last, l.prelast};
+    }
+
+    bool operator==(const Class &a, const Class &b){
+        return a.first == b.first && a.last == b.last && a.prelast == b.prelast;
+    }
+
+    struct Graph {
+        std::vector<Class> classes;
+        std::vector<std::uint32_t> counts; ///< сколько городов класса ещё не названо
+        std::array<std::vector<std::uint32_t>, LETTERS> by_first;
+
+        Graph(const CityDictionary &dict, const UsedSet &used){
+            std::unordered_map<std::uint32_t, std::uint32_t> ids;
+            for (std::uint32_t id = 0; id < dict.size(); id++){
+                if (used.contains(id))
+                    continue;
+                Class c = class_of(dict.letters(id));
+                std::uint32_t key = (c.first << 16) | (c.last << 8) | c.prelast;
+                auto [it, fresh] = ids.emplace(key, classes.size());
+                if (fresh){
+                    classes.push_back(c);
+                    counts.push_back(0);
+                    by_first[c.first].push_back(it->second);
+                }
+                counts[it->second]++;
+            }
+        }
+    };
+
+    // поиск с запоминанием; ключ позиции - отсортированный список классов,
+    // сыгранных от корня, и буквы, на которые надо ходить
+    class Search {
+    public:
+        Search(const Graph &g, const SolverLimits &limits) : g(g), counts(g.counts), limits(limits) {}
+
+        // ходы из позиции, где надо назвать город на l1 (или на l2, если на l1 нечего)
+        void moves(Letter l1, Letter l2, std::vector<std::uint32_t> &out) const{
+            out.clear();
+            for (Letter l : {l1, l2}){
+                if (l == NOT_LETTER)
+                    continue; // на не букву ответить нечем
+                for (std::uint32_t c : g.by_first[l]){
+                    if (counts[c] > 0)
+                        out.push_back(c);
+                }
+                if (!out.empty())
+                    break;
+            }
+        }
+
+        void play(std::uint32_t c){
+            counts[c]--;
+            played.insert(std::upper_bound(played.begin(), played.end(), c), c);
+        }
+
+        void undo(std::uint32_t c){
+            counts[c]++;
+            played.erase(std::lower_bound(played.begin(), played.end(), c));
+        }
+
+        // выигрывает ли сторона, которой ходить после города класса c
+        bool wins_after(std::uint32_t c){
+            const Class &prev = g.classes[c];
+            if (aborted || ++nodes > limits.nodes || played.size() > limits.depth){
+                aborted = true;
+                return false;
+            }
+            std::string key(reinterpret_cast<const char *>(played.data()), played.size() * sizeof(std::uint32_t));
+            key += char(prev.last);
+            key += char(prev.prelast);
+            auto it = memo.find(key);
+            if (it != memo.end())
+                return it->second;
+
+            std::vector<std::uint32_t> options;
+            moves(prev.last, prev.prelast, options);
+            bool res = false;
+            for (std::uint32_t next : options){
+                play(next);
+                bool lost = !wins_after(next);
+                undo(next);
+                if (aborted)
+                    return false;
+                if (lost){
+                    res = true;
+                    break;
+                }
+            }
+            memo.emplace(std::move(key), res);
+            return res;
+        }
+
+        const Graph &g;
+        std::vector<std::uint32_t> counts;
+        std::vector<std::uint32_t> played;
+        std::unordered_map<std::string, bool> memo;
+        const SolverLimits &limits;
+        std::size_t nodes = 0;
+        bool aborted = false;
+    };
+
+    // последний неназванный город класса c
+    std::string_view city_of(const CityDictionary &dict, const UsedSet &used, const Class &c){
+        auto [first, last] = dict.bucket(c.first);
+        for (std::uint32_t id = last; id > first; id--){
+            if (!used.contains(id - 1) && class_of(dict.letters(id - 1)) == c)
+                return dict.name(id - 1);
+        }
+        return {};
+    }
+}
+
+    Verdict solve(const std::vector<std::string> &history, const CityDictionary &dict, SolverLimits limits){
+        if (history.empty() || history.back().empty()){
+            throw std::runtime_error("Empty history");
+        }
+        UsedSet used(dict);
+        used.sync(history);
+        Graph g(dict, used);
+        Class before = class_of(letters_of(history.back()));
+
+        std::vector<std::uint32_t> options;
+        Search(g, limits).moves(before.last, before.prelast, options);
+        Verdict res;
+        if (options.empty()){
+            res.outcome = Verdict::loss;
+            return res;
+        }
+
+        // каждый ход из корня считается отдельно, со своей таблицей позиций
+        enum : char { pending, lost, won, aborted };
+        std::vector<char> results(options.size(), pending);
+        std::atomic<std::size_t> next = 0, nodes = 0;
+        std::atomic<bool> found = false;
+        auto worker = [&]{
+            for (std::size_t i; !found && (i = next++) < options.size();){
+                Search s(g, limits);
+                s.play(options[i]);
+                bool opponent = s.wins_after(options[i]);
+                nodes += s.nodes;
+                if (s.aborted)
+                    results[i] = aborted;
+                else if (opponent)
+                    results[i] = lost;
+                else {
+                    results[i] = won;
+                    found = true;
+                }
+            }
+        };
+        unsigned threads = limits.threads ? limits.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<std::size_t>(threads, options.size());
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; i++)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread &t : pool)
+            t.join();
+
+        // выигрывающий ход, иначе ход с неизвестным исходом, иначе любой
+        auto pick = [&](char r) -> std::size_t { return std::find(results.begin(), results.end(), r) - results.begin(); };
+        std::size_t best = pick(won);
+        res.outcome = Verdict::win;
+        if (best == options.size()){
+            best = pick(aborted);
+            res.outcome = best == options.size() && pick(pending) == options.size() ? Verdict::loss : Verdict::unknown;
+            if (best == options.size())
+                best = 0;
+        }
+        res.move = city_of(dict, used, g.classes[options[best]]);
+        res.nodes = nodes;
+        return res;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef OOPPROG1_SOLVER_H
+#define OOPPROG1_SOLVER_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "dict.hpp"
+namespace Prog1 {
+    // результат перебора для стороны, которой ходить
+    struct Verdict {
+        enum Outcome {
+            win,     ///< есть выигрывающий ход
+            loss,    ///< любой ход проигрывает
+            unknown  ///< перебор не уложился в ограничения
+        };
+        Outcome outcome = unknown;
+        std::string_view move; ///< рекомендуемый ход, пустой - ходить нечем
+        std::size_t nodes = 0; ///< число рассмотренных позиций
+    };
+
+    // ограничения перебора на каждый ход из корня
+    struct SolverLimits {
+        std::size_t nodes = 1 << 20;
+        std::size_t depth = 1024;
+        unsigned threads = 0; ///< 0 - по числу ядер
+    };
+
+    // перебор с запоминанием: может ли сторона, которой ходить после истории,
+    // выиграть при любой игре соперника. Правила те же, что в game: город на
+    // последнюю букву, а если таких нет - на предпоследнюю; кто не может
+    // сходить, проиграл. Ходы из корня перебираются параллельно
+    Verdict solve(const std::vector<std::string> &history, const CityDictionary &dict, SolverLimits limits = {});
+}
+#endif //OOPPROG1_SOLVER_H
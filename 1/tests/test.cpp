@@ -0,0 +1,294 @@
+#include <catch2/catch_test_macros.hpp>
+#define CATCH_CONFIG_MAIN
+
+#include "dict.hpp"
+#include "fastin.hpp"
+#include "prog.hpp"
+#include "reload.hpp"
+#include "session.hpp"
+#include "solver.hpp"
+#include "trie.hpp"
+#include "used.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <catch2/catch_all.hpp>
+using namespace Prog1;
+
+namespace {
+  // список городов во временном файле, по городу на строку
+  std::string write_list(const std::string &name, const std::vector<std::string> &cities){
+    std::string path = (std::filesystem::temp_directory_path() / ("prog1_" + name + ".txt")).string();
+    std::ofstream out(path, std::ios::trunc);
+    for (const std::string &city : cities)
+      out << city << '\n';
+    return path;
+  }
+}
+
+TEST_CASE("used set follows one game"){
+  CityDictionary dict(write_list("used", {"Moscow", "Warsaw", "Wien", "Nairobi", "Ibiza"}));
+  auto id = [&dict](const char *city){ return dict.find(city); };
+  UsedSet used(dict);
+  used.sync(std::vector<std::string>{"Moscow", "Warsaw"});
+  REQUIRE(used.size() == 2);
+
+  // продолжение той же игры только дописывается
+  used.sync(std::vector<std::string>{"Moscow", "Warsaw", "Wien"});
+  REQUIRE(used.size() == 3);
+
+  // другая игра той же или большей длины не смешивается со старой
+  used.sync(std::vector<std::string>{"Nairobi", "Ibiza", "Moscow"});
+  REQUIRE(used.size() == 3);
+  REQUIRE_FALSE(used.contains(id("Warsaw")));
+  REQUIRE(used.contains(id("Ibiza")));
+  const char *other[]{"Wien", "Nairobi", "Ibiza", "Moscow", nullptr};
+  used.sync(other);
+  REQUIRE(used.size() == 4);
+  const char *changed[]{"Wien", "Nairobi", "Moscow", "Warsaw", "Ibiza", nullptr};
+  used.sync(changed);
+  REQUIRE(used.size() == 5);
+  REQUIRE(used.left(letters_of("W").first) == 0);
+
+  // более короткая история - тоже новая игра
+  used.sync(std::vector<std::string>{"Warsaw"});
+  REQUIRE(used.size() == 1);
+}
+
+TEST_CASE("compiled dictionary rejects corrupt tables"){
+  CityDictionary text(write_list("compiled", {"Moscow", "Warsaw", "Wien", "Nairobi"}));
+  std::string bin = (std::filesystem::temp_directory_path() / "prog1_compiled.bin").string();
+  text.save(bin);
+  CityDictionary good(bin);
+  REQUIRE(good.compiled());
+  REQUIRE(good.name(good.find("Wien")) == "Wien");
+
+  std::string bytes;
+  {
+    std::ifstream in(bin, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  // заголовок 32 байта, за ним LETTERS * LETTERS + 1 смещений и записи
+  // {смещение, длина, буквы}; размер файла при порче не меняется
+  const std::size_t offsets = 32, entries = offsets + (LETTERS * LETTERS + 1) * 4;
+  auto broken = [&](std::size_t at, std::uint32_t value){
+    std::string copy = bytes;
+    std::memcpy(copy.data() + at, &value, sizeof(value));
+    std::ofstream(bin, std::ios::binary | std::ios::trunc) << copy;
+    try {
+      CityDictionary dict(bin);
+    }
+    catch(const std::runtime_error &e){
+      return std::string(e.what());
+    }
+    return std::string();
+  };
+  REQUIRE(broken(offsets + 4, UINT32_MAX) == "Broken dictionary offsets");
+  REQUIRE(broken(entries, UINT32_MAX - 2) == "Broken dictionary entry");
+  REQUIRE(broken(entries + 4, 1 << 20) == "Broken dictionary entry");
+  REQUIRE(broken(offsets, 1) == "Broken dictionary header");
+}
+
+TEST_CASE("default answer follows file order"){
+  std::string path = write_list("order", {"Wc", "Wa", "Wb", "Aw"});
+  CityDictionary text(path);
+  std::string bin = (std::filesystem::temp_directory_path() / "prog1_order.bin").string();
+  text.save(bin);
+  CityDictionary compiled(bin);
+  for (const CityDictionary *dict : {&text, &compiled}){
+    REQUIRE(game(std::vector<std::string>{"Aw"}, *dict) == "Wb");
+    REQUIRE(game(std::vector<std::string>{"Aw", "Wb", "Bw"}, *dict) == "Wa");
+    // пары букв видят те же города
+    auto [first, last] = dict->pair_bucket(letters_of("W").first, letters_of("c").first);
+    REQUIRE(last - first == 1);
+    REQUIRE(dict->name(dict->by_pair(first)) == "Wc");
+  }
+}
+
+TEST_CASE("solve"){
+  // q ни с чего не начинается, поэтому ход по предпоследней букве не спасает
+  CityDictionary dict(write_list("solve", {"Aqb", "Bqc", "Bqd", "Dqe", "Xqa"}));
+
+  // Bqc не оставляет сопернику ходов, Bqd отдаёт ему Dqe
+  Verdict v = solve({"Aqb"}, dict);
+  REQUIRE(v.outcome == Verdict::win);
+  REQUIRE(v.move == "Bqc");
+
+  v = solve({"Bqd"}, dict);
+  REQUIRE(v.outcome == Verdict::win);
+  REQUIRE(v.move == "Dqe");
+
+  // единственный ответ Aqb, на него есть выигрывающий Bqc
+  v = solve({"Xqa"}, dict);
+  REQUIRE(v.outcome == Verdict::loss);
+
+  v = solve({"Aqb", "Bqc"}, dict);
+  REQUIRE(v.outcome == Verdict::loss);
+  REQUIRE(v.move.empty());
+}
+
+TEST_CASE("greedy scores only letters the opponent can continue"){
+  // после Abd у соперника один ответ, после Abc - два. На z и на цифру
+  // ничего нет: соперник пойдёт по предпоследней b, это не тупик
+  CityDictionary dict(write_list("greedy", {"Ab1", "Abz", "Abc", "Abd", "Bq", "Cx", "Cy", "Dx"}));
+  GameSession session(dict, Strategy::greedy);
+  session.play("Xa");
+  REQUIRE(session.respond() == "Abd");
+  session.play("Xa");
+  REQUIRE(session.respond() == "Abc");
+  // города на букву без городов и на не букву - только когда других нет
+  session.play("Xa");
+  REQUIRE(session.respond() == "Abz");
+  session.play("Xa");
+  REQUIRE(session.respond() == "Ab1");
+}
+
+TEST_CASE("script input across buffer boundary"){
+  // буфер - 1 MiB: слово boundary лежит поперёк его конца,
+  // а последнее длинное слово больше всего буфера
+  const std::size_t buffer = 1 << 20;
+  std::string text(buffer - 4, 'x');
+  text += "\nboundary +42 7 Москва\n";
+  std::string longest(3 * buffer, 'y');
+  text += longest + " end";
+  std::string path = (std::filesystem::temp_directory_path() / "prog1_script.txt").string();
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  REQUIRE(fd != -1);
+  ScriptInput::enable(fd);
+  ScriptInput &in = *ScriptInput::active();
+  REQUIRE(in.get_word().size() == buffer - 4);
+  REQUIRE(in.get_word() == "boundary");
+  REQUIRE(in.get<int>(0, 100) == 42);
+  REQUIRE(in.get<int>(0, 100) == 7);
+  REQUIRE(in.get_word() == "Москва");
+  REQUIRE(in.get_word() == longest);
+  // последнее слово без перевода строки
+  REQUIRE(in.get_word() == "end");
+  std::string_view w;
+  REQUIRE_FALSE(in.word(w));
+  REQUIRE_FALSE(in.failed());
+  REQUIRE_THROWS(in.get_word());
+  close(fd);
+}
+
+TEST_CASE("reloaded snapshot survives in-place rewrite"){
+  std::string path = write_list("reload", {"Moscow", "Wusterwitz", "Xanten", "Zagreb"});
+  LiveDictionary live(path);
+  std::shared_ptr<const CityDictionary> old = live.current();
+
+  // файл переписывается на месте и становится короче
+  write_list("reload", {"Oslo"});
+  REQUIRE(old->size() == 4);
+  REQUIRE(old->find("Zagreb") != CityDictionary::npos);
+  REQUIRE(old->name(old->find("Wusterwitz")) == "Wusterwitz");
+
+  live.reload();
+  REQUIRE(live.version() == 1);
+  REQUIRE(live.current()->size() == 1);
+  REQUIRE(live.current()->find("Oslo") != CityDictionary::npos);
+
+  // то же через inotify
+  live.watch();
+  std::shared_ptr<const CityDictionary> before = live.current();
+  write_list("reload", {"Riga", "Tallinn"});
+  for (int i = 0; i < 500 && live.version() == 1; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  REQUIRE(live.version() > 1);
+  REQUIRE(before->name(0) == "Oslo");
+  REQUIRE(live.current()->find("Tallinn") != CityDictionary::npos);
+  REQUIRE(old->find("Moscow") != CityDictionary::npos);
+}
+
+TEST_CASE("trie agrees with dictionary"){
+  std::vector<std::string> cities{
+    "Amsterdam", "amsterdam", "Ankara", "Athens", "Berlin", "Bern", "Bergen",
+    "Москва", "мурманск", "Минск", "Ёлки", "елец", "Oslo", "Osaka", "Z", "1st Street"};
+  std::string path = write_list("trie", cities);
+  CityDictionary dict(path);
+  CityTrie trie(path);
+  REQUIRE(trie.size() == dict.size());
+  REQUIRE(trie.size() == cities.size());
+
+  for (std::uint32_t id = 0; id < dict.size(); id++){
+    std::string_view name = dict.name(id);
+    std::uint32_t t = trie.find(name);
+    REQUIRE(t != CityTrie::npos);
+    REQUIRE(trie.name(t) == name);
+    REQUIRE(dict.find(name) == id);
+  }
+  for (const char *missing : {"Amster", "Bernx", "", "москва", "Zz"}){
+    REQUIRE(trie.find(missing) == CityTrie::npos);
+    REQUIRE(dict.find(missing) == CityDictionary::npos);
+  }
+
+  // корзины букв совпадают по составу
+  for (Letter l = 1; l < LETTERS; l++){
+    auto [first, last] = dict.bucket(l);
+    std::set<std::string> expected, visited, ranged;
+    for (std::uint32_t id = first; id < last; id++)
+      expected.emplace(dict.name(id));
+    trie.visit(l, [&](std::uint32_t id, std::string_view name){
+      REQUIRE(trie.name(id) == name);
+      visited.emplace(name);
+    });
+    for (CityTrie::Range r : trie.buckets(l)){
+      for (std::uint32_t id = r.first; id < r.second; id++)
+        ranged.insert(trie.name(id));
+    }
+    REQUIRE(visited == expected);
+    REQUIRE(ranged == expected);
+  }
+  for (CityTrie::Range r : trie.buckets(NOT_LETTER))
+    REQUIRE(r.first == r.second);
+}
+
+TEST_CASE("random strategy never repeats a city"){
+  // все города начинаются и заканчиваются на a: каждый ответ - снова на a
+  std::vector<std::string> cities;
+  for (char c1 = 'b'; c1 <= 'k'; c1++){
+    for (char c2 = 'b'; c2 <= 'k'; c2++)
+      cities.push_back(std::string("A") + c1 + c2 + "a");
+  }
+  CityDictionary dict(write_list("random", cities));
+
+  for (std::uint64_t seed : {1, 2, 3}){
+    GameSession session(dict, Strategy::random, seed);
+    session.play("Zqa");
+    std::set<std::string> named;
+    std::size_t opponent = 0;
+    bool repeated = false;
+    for (std::size_t turn = 0; named.size() < cities.size(); turn++){
+      // соперник иногда сам называет город из корзины
+      if (turn % 4 == 3){
+        while (named.contains(cities[opponent]))
+          opponent++;
+        session.play(cities[opponent]);
+        named.insert(cities[opponent]);
+        if (named.size() == cities.size())
+          break;
+      }
+      repeated = repeated || !named.emplace(session.respond()).second;
+    }
+    REQUIRE_FALSE(repeated);
+    REQUIRE_THROWS(session.respond());
+  }
+
+  // одинаковый seed - одинаковая партия
+  GameSession a(dict, Strategy::random, 42), b(dict, Strategy::random, 42);
+  a.play("Zqa");
+  b.play("Zqa");
+  for (int i = 0; i < 20; i++)
+    REQUIRE(a.respond() == b.respond());
+}
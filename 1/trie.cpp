@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "mapped.hpp"
+#include "trie.hpp"
+
+namespace Prog1 {
+namespace {
+    // UTF-8 строчной и заглавной формы буквы, по возрастанию байт
+    std::array<std::string, 2> spellings(Letter l){
+        auto utf8 = [](char32_t c){
+            std::string res;
+            if (c < 0x80)
+                res += char(c);
+            else {
+                // буквы таблицы лежат ниже U+0800, им хватает двух байт
+                res += char(0xC0 | (c >> 6));
+                res += char(0x80 | (c & 0x3F));
+            }
+            return res;
+        };
+        if (l == NOT_LETTER || l >= LETTERS)
+            return {};
+        std::array<std::string, 2> res{utf8(LETTER_CASES[l].upper), utf8(LETTER_CASES[l].lower)};
+        if (res[1] < res[0])
+            std::swap(res[0], res[1]);
+        return res;
+    }
+}
+
+    CityTrie::CityTrie(const std::string &filename){
+        // файл нужен только на время построения: метки копируются в labels
+        MappedFile file(filename);
+        std::string_view text = file.view();
+        std::vector<std::string_view> names;
+        while (!text.empty()){
+            std::size_t end = text.find('\n');
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            if (!line.empty())
+                names.push_back(line);
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        if (names.size() >= npos){
+            throw std::runtime_error("Dictionary is too large");
+        }
+        count = names.size();
+
+        nodes.push_back({0, 0, 0, 0, 0, 0});
+        build(names, 0, 0, names.size(), 0);
+        nodes.shrink_to_fit();
+        labels.shrink_to_fit();
+        if (labels.size() > UINT32_MAX){
+            throw std::runtime_error("Dictionary is too large");
+        }
+    }
+
+    void CityTrie::build(std::vector<std::string_view> &names, std::uint32_t node,
+                         std::size_t lo, std::size_t hi, std::size_t depth){
+        // у всех names[lo, hi) общий префикс длины depth - путь до node
+        nodes[node].rank = lo;
+        if (lo < hi && names[lo].size() == depth){
+            nodes[node].terminal = 1;
+            lo++;
+        }
+        // остальные группируются по следующему байту
+        std::vector<std::pair<std::size_t, std::size_t>> groups;
+        for (std::size_t i = lo; i < hi;){
+            std::size_t j = i + 1;
+            while (j < hi && names[j][depth] == names[i][depth])
+                j++;
+            groups.push_back({i, j});
+            i = j;
+        }
+        std::uint32_t first = nodes.size();
+        nodes[node].child = first;
+        nodes[node].children = groups.size();
+        nodes.resize(first + groups.size());
+        for (std::size_t k = 0; k < groups.size(); k++){
+            auto [a, b] = groups[k];
+            // общий префикс отсортированной группы - общий префикс её крайних строк
+            std::string_view x = names[a], y = names[b - 1];
+            std::size_t len = depth + 1;
+            while (len < x.size() && len < y.size() && x[len] == y[len] && len - depth < UINT8_MAX)
+                len++;
+            Node &c = nodes[first + k];
+            c.label = labels.size();
+            c.length = len - depth;
+            labels.append(x.substr(depth, len - depth));
+            build(names, first + k, a, b, len);
+        }
+    }
+
+    std::size_t CityTrie::memory() const{
+        return sizeof(*this) + nodes.capacity() * sizeof(Node) + labels.capacity();
+    }
+
+    std::uint32_t CityTrie::child_of(const Node &node, char c) const{
+        auto first = nodes.begin() + node.child, last = first + node.children;
+        auto it = std::lower_bound(first, last, static_cast<unsigned char>(c), [this](const Node &n, unsigned char v){
+            return static_cast<unsigned char>(labels[n.label]) < v;
+        });
+        if (it == last || labels[it->label] != c)
+            return npos;
+        return it - nodes.begin();
+    }
+
+    std::uint32_t CityTrie::rank_end(const Node &node, std::uint32_t end, std::uint32_t i) const{
+        return i + 1 < node.children ? nodes[node.child + i + 1].rank : end;
+    }
+
+    std::uint32_t CityTrie::find(std::string_view city) const{
+        std::uint32_t n = 0;
+        for (std::size_t pos = 0; pos < city.size();){
+            n = child_of(nodes[n], city[pos]);
+            if (n == npos)
+                return npos;
+            const Node &c = nodes[n];
+            if (city.substr(pos, c.length) != std::string_view(labels).substr(c.label, c.length))
+                return npos;
+            pos += c.length;
+        }
+        return nodes[n].terminal ? nodes[n].rank : npos;
+    }
+
+    std::string CityTrie::name(std::uint32_t id) const{
+        std::string res;
+        std::uint32_t n = 0;
+        while (!(nodes[n].terminal && nodes[n].rank == id)){
+            // спускаемся в последнего ребёнка, поддерево которого начинается не позже id
+            const Node &p = nodes[n];
+            auto first = nodes.begin() + p.child, last = first + p.children;
+            auto it = std::upper_bound(first, last, id, [](std::uint32_t v, const Node &c){ return v < c.rank; });
+            if (it == first){
+                throw std::out_of_range("Unknown city id");
+            }
+            n = (it - 1) - nodes.begin();
+            res.append(labels, nodes[n].label, nodes[n].length);
+        }
+        return res;
+    }
+
+    std::uint32_t CityTrie::locate(std::string_view prefix, std::string &path, std::uint32_t &end) const{
+        std::uint32_t n = 0;
+        path.clear();
+        end = count;
+        for (std::size_t pos = 0; pos < prefix.size();){
+            const Node &p = nodes[n];
+            std::uint32_t c = child_of(p, prefix[pos]);
+            if (c == npos)
+                return npos;
+            end = rank_end(p, end, c - p.child);
+            std::string_view label = std::string_view(labels).substr(nodes[c].label, nodes[c].length);
+            std::size_t k = std::min(label.size(), prefix.size() - pos);
+            if (label.substr(0, k) != prefix.substr(pos, k))
+                return npos;
+            path += label;
+            pos += label.size();
+            n = c;
+        }
+        return n;
+    }
+
+    std::array<CityTrie::Range, 2> CityTrie::buckets(Letter l) const{
+        std::array<Range, 2> res{Range{0, 0}, Range{0, 0}};
+        std::string path;
+        std::size_t k = 0;
+        for (const std::string &s : spellings(l)){
+            std::uint32_t end;
+            std::uint32_t n = s.empty() ? npos : locate(s, path, end);
+            if (n != npos)
+                res[k++] = {nodes[n].rank, end};
+        }
+        return res;
+    }
+
+    void CityTrie::visit(Letter l, const std::function<void(std::uint32_t, std::string_view)> &f) const{
+        std::string path;
+        for (const std::string &s : spellings(l)){
+            std::uint32_t end;
+            std::uint32_t n = s.empty() ? npos : locate(s, path, end);
+            if (n != npos)
+                walk(n, path, f);
+        }
+    }
+
+    void CityTrie::walk(std::uint32_t node, std::string &prefix,
+                        const std::function<void(std::uint32_t, std::string_view)> &f) const{
+        const Node &n = nodes[node];
+        if (n.terminal)
+            f(n.rank, prefix);
+        for (std::uint32_t i = n.child; i < n.child + n.children; i++){
+            std::size_t before = prefix.size();
+            prefix.append(labels, nodes[i].label, nodes[i].length);
+            walk(i, prefix, f);
+            prefix.resize(before);
+        }
+    }
+}
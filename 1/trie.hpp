@@ -0,0 +1,67 @@
+#ifndef OOPPROG1_TRIE_H
+#define OOPPROG1_TRIE_H
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "dict.hpp"
+namespace Prog1 {
+    // сжатый префиксный словарь городов для очень больших списков.
+    // Общие префиксы хранятся один раз, цепочки без ветвлений склеены в одну
+    // дугу. Идентификатор города - его номер в алфавитном (побайтовом) порядке,
+    // поэтому города одного поддерева занимают подряд идущие номера
+    class CityTrie {
+    public:
+        using Range = CityDictionary::Range;
+
+        static constexpr std::uint32_t npos = CityDictionary::npos;
+
+        // строит словарь из текстового списка (город на строку)
+        explicit CityTrie(const std::string &filename);
+
+        std::size_t size() const { return count; }
+        // сколько байт занимают узлы и метки
+        std::size_t memory() const;
+
+        // идентификатор города или npos, если его нет в словаре
+        std::uint32_t find(std::string_view city) const;
+        // название собирается по пути от корня, O(длина * log ветвления)
+        std::string name(std::uint32_t id) const;
+        // города на букву l: поддеревья строчной и заглавной буквы,
+        // по возрастанию; второй диапазон может быть пустым.
+        // Для NOT_LETTER оба диапазона пустые
+        std::array<Range, 2> buckets(Letter l) const;
+        // обходит города на букву l по алфавиту, не собирая каждое название заново
+        void visit(Letter l, const std::function<void(std::uint32_t, std::string_view)> &f) const;
+
+    private:
+        struct Node {
+            std::uint32_t label;     ///< смещение метки дуги в labels
+            std::uint32_t child;     ///< первый ребёнок, дети идут подряд
+            std::uint32_t rank;      ///< идентификатор первого города поддерева
+            std::uint16_t children;
+            std::uint8_t length;     ///< длина метки
+            std::uint8_t terminal;   ///< на узле заканчивается город
+        };
+
+        void build(std::vector<std::string_view> &names, std::uint32_t node,
+                   std::size_t lo, std::size_t hi, std::size_t depth);
+        // узел, на котором или внутри дуги которого заканчивается путь prefix,
+        // или npos. path - путь до конца дуги узла, end - конец диапазона поддерева
+        std::uint32_t locate(std::string_view prefix, std::string &path, std::uint32_t &end) const;
+        // ребёнок node, метка которого начинается с c, или npos
+        std::uint32_t child_of(const Node &node, char c) const;
+        // конец диапазона идентификаторов поддерева i-го ребёнка node
+        std::uint32_t rank_end(const Node &node, std::uint32_t end, std::uint32_t i) const;
+        void walk(std::uint32_t node, std::string &prefix,
+                  const std::function<void(std::uint32_t, std::string_view)> &f) const;
+
+        std::vector<Node> nodes; ///< nodes[0] - корень
+        std::string labels;
+        std::uint32_t count = 0;
+    };
+}
+#endif //OOPPROG1_TRIE_H
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "dict.hpp"
+#include "trie.hpp"
+using namespace Prog1;
+
+// сравнивает память и скорость поиска трёх представлений словаря:
+// отсортированного вектора строк, CityDictionary и сжатого CityTrie
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    template<class F>
+    double nanoseconds(std::size_t n, F f){
+        Clock::time_point start = Clock::now();
+        f();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / n;
+    }
+
+    void row(const char *name, std::size_t bytes, double find, double visit){
+        std::printf("%-16s %12zu %12.1f %12.1f\n", name, bytes, find, visit);
+    }
+}
+
+// trie_bench [list.txt] [запросов]
+int main(int argc, char **argv) {
+    std::string filename = argc > 1 ? argv[1] : "list.txt";
+    std::size_t queries = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    try {
+        std::vector<std::string> plain;
+        {
+            std::ifstream in(filename);
+            if (!in.is_open()){
+                throw std::runtime_error("Error in open file");
+            }
+            for (std::string line; std::getline(in, line);){
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    plain.push_back(line);
+            }
+            std::sort(plain.begin(), plain.end());
+            plain.erase(std::unique(plain.begin(), plain.end()), plain.end());
+            plain.shrink_to_fit();
+        }
+        CityDictionary dict(filename);
+        CityTrie trie(filename);
+        if (plain.empty()){
+            throw std::runtime_error("Empty dictionary");
+        }
+
+        // половина запросов - города из словаря, половина - промахи
+        std::mt19937_64 rng(42);
+        std::vector<std::string> sample(queries);
+        for (std::string &s : sample){
+            s = plain[rng() % plain.size()];
+            if (rng() & 1)
+                s += 'x';
+        }
+
+        std::size_t plain_bytes = sizeof(plain) + plain.capacity() * sizeof(std::string);
+        for (const std::string &s : plain){
+            if (s.capacity() > std::string().capacity())
+                plain_bytes += s.capacity() + 1;
+        }
+
+        std::size_t hits[3] = {0, 0, 0}, letters[3] = {0, 0, 0};
+        double find[3], visit[3];
+        find[0] = nanoseconds(queries, [&]{
+            for (const std::string &s : sample)
+                hits[0] += std::binary_search(plain.begin(), plain.end(), s);
+        });
+        find[1] = nanoseconds(queries, [&]{
+            for (const std::string &s : sample)
+                hits[1] += dict.find(s) != CityDictionary::npos;
+        });
+        find[2] = nanoseconds(queries, [&]{
+            for (const std::string &s : sample)
+                hits[2] += trie.find(s) != CityTrie::npos;
+        });
+        // перебор всех городов по первой букве; города не на букву не перебираются
+        visit[0] = nanoseconds(plain.size(), [&]{
+            for (const std::string &s : plain){
+                if (letters_of(s).first != NOT_LETTER)
+                    letters[0] += s.size();
+            }
+        });
+        visit[1] = nanoseconds(dict.size(), [&]{
+            for (std::size_t l = 1; l < LETTERS; l++){
+                auto [first, last] = dict.bucket(l);
+                for (std::uint32_t id = first; id < last; id++)
+                    letters[1] += dict.name(id).size();
+            }
+        });
+        visit[2] = nanoseconds(trie.size(), [&]{
+            for (std::size_t l = 1; l < LETTERS; l++){
+                trie.visit(l, [&](std::uint32_t, std::string_view s){ letters[2] += s.size(); });
+            }
+        });
+        if (hits[0] != hits[1] || hits[0] != hits[2] || letters[0] != letters[1] || letters[0] != letters[2]){
+            throw std::runtime_error("Backends disagree");
+        }
+
+        std::printf("%zu cities, %zu queries (%zu hits)\n", plain.size(), queries, hits[0]);
+        std::printf("%-16s %12s %12s %12s\n", "backend", "bytes", "find ns", "visit ns");
+        row("vector<string>", plain_bytes, find[0], visit[0]);
+        row("CityDictionary", dict.memory(), find[1], visit[1]);
+        row("CityTrie", trie.memory(), find[2], visit[2]);
+    }
+    catch(const std::bad_alloc& ba) {
+        std::cerr << "Not enough memory" << std::endl;
+        return 1;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
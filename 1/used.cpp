@@ -0,0 +1,65 @@
+#include <string>
+#include <vector>
+#include "used.hpp"
+
+namespace Prog1 {
+    void UsedSet::add(std::string_view city){
+        std::uint32_t id = dict->find(city);
+        if (id != CityDictionary::npos)
+            add(id);
+    }
+
+    void UsedSet::add(std::uint32_t id){
+        if (!ids.insert(id).second)
+            return;
+        Letters l = dict->letters(id);
+        named[l.first]++;
+        named_pairs[l.first * LETTERS + l.last]++;
+    }
+
+    std::uint32_t UsedSet::left(Letter l) const{
+        auto [first, last] = dict->bucket(l);
+        auto it = named.find(l);
+        return last - first - (it == named.end() ? 0 : it->second);
+    }
+
+    std::uint32_t UsedSet::left(Letter first, Letter last) const{
+        auto it = named_pairs.find(first * LETTERS + last);
+        return dict->transitions(first, last) - (it == named_pairs.end() ? 0 : it->second);
+    }
+
+    void UsedSet::clear(){
+        ids.clear();
+        named.clear();
+        named_pairs.clear();
+        seen = 0;
+        first_move.clear();
+        last_move.clear();
+    }
+
+    void UsedSet::sync(const std::vector<std::string> &history){
+        std::size_t n = history.size();
+        if (n < seen || (seen > 0 && !continues(history[0], history[seen - 1])))
+            clear();
+        for (; seen < n; seen++)
+            add(history[seen]);
+        if (seen > 0){
+            first_move = history[0];
+            last_move = history[seen - 1];
+        }
+    }
+
+    void UsedSet::sync(const char **history){
+        std::size_t n = 0;
+        while (history[n] != nullptr)
+            n++;
+        if (n < seen || (seen > 0 && !continues(history[0], history[seen - 1])))
+            clear();
+        for (; seen < n; seen++)
+            add(history[seen]);
+        if (seen > 0){
+            first_move = history[0];
+            last_move = history[seen - 1];
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef OOPPROG1_USED_H
+#define OOPPROG1_USED_H
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "dict.hpp"
+namespace Prog1 {
+    // множество уже названных городов по их идентификаторам в словаре;
+    // память растёт с числом ходов, а не с размером словаря
+    class UsedSet {
+    public:
+        // узлы множества берутся из mr, например из StringArena хода
+        explicit UsedSet(const CityDictionary &dict, std::pmr::memory_resource *mr = std::pmr::get_default_resource())
+            : dict(&dict), ids(mr), named(mr), named_pairs(mr), first_move(mr), last_move(mr) {}
+
+        const CityDictionary &dictionary() const { return *dict; }
+
+        // добавляет ходы истории, которых ещё не видели. Истории подряд идущих
+        // ходов одной игры должны продолжать друг друга; если история короче
+        // учтённой или её первый и последний учтённый ходы не совпадают
+        // с запомненными, она считается новой игрой
+        void sync(const std::vector<std::string> &history);
+        void sync(const char **history);
+
+        // города не из словаря не могут быть ответом, их не запоминаем
+        void add(std::string_view city);
+        void add(std::uint32_t id);
+        bool contains(std::uint32_t id) const { return ids.contains(id); }
+        std::size_t size() const { return ids.size(); }
+        void clear();
+
+        // сколько ещё не названо городов на букву l и городов,
+        // ведущих с буквы first на букву last; O(1)
+        std::uint32_t left(Letter l) const;
+        std::uint32_t left(Letter first, Letter last) const;
+
+    private:
+        const CityDictionary *dict;
+        std::pmr::unordered_set<std::uint32_t> ids;
+        // сколько названо по первой букве и по паре букв
+        std::pmr::unordered_map<Letter, std::uint32_t> named;
+        std::pmr::unordered_map<std::uint32_t, std::uint32_t> named_pairs;
+        std::size_t seen = 0; ///< сколько ходов истории уже учтено
+        // первый и последний учтённые ходы: по ним видно, что пришла другая игра
+        std::pmr::string first_move;
+        std::pmr::string last_move;
+        bool continues(std::string_view first, std::string_view last) const {
+            return first == first_move && last == last_move;
+        }
+    };
+}
+#endif //OOPPROG1_USED_H
@@ -0,0 +1,79 @@
+#include <cstddef>
+#include "word.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WORD_SIMD 1
+#endif
+
+namespace Prog1 {
+namespace {
+    bool valid_scalar(const char *p, std::size_t n){
+        for (std::size_t i = 0; i < n; i++){
+            if (EVIL_TABLE[static_cast<unsigned char>(p[i])])
+                return false;
+        }
+        return true;
+    }
+
+#ifdef WORD_SIMD
+    // EVIL без цифр: цифры проверяются одним сравнением диапазона
+    constexpr std::string_view SPECIAL = EVIL.substr(10);
+
+    // сколько байтов с начала проверено целыми блоками по 16 (хвост короче
+    // блока остаётся скалярной проверке). Если найден плохой символ, ok = false,
+    // а результат - смещение блока, в котором он найден
+    std::size_t valid_sse2(const char *p, std::size_t n, bool &ok){
+        const __m128i lo = _mm_set1_epi8('0' - 1), hi = _mm_set1_epi8('9' + 1);
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+            // байты >= 0x80 отрицательны и в диапазон цифр не попадают
+            __m128i bad = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+            for (char c : SPECIAL)
+                bad = _mm_or_si128(bad, _mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+            if (_mm_movemask_epi8(bad) != 0){
+                ok = false;
+                return i;
+            }
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t valid_avx2(const char *p, std::size_t n, bool &ok){
+        const __m256i lo = _mm256_set1_epi8('0' - 1), hi = _mm256_set1_epi8('9' + 1);
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32){
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+            __m256i bad = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+            for (char c : SPECIAL)
+                bad = _mm256_or_si256(bad, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+            if (_mm256_movemask_epi8(bad) != 0){
+                ok = false;
+                return i;
+            }
+        }
+        return i;
+    }
+#endif
+}
+
+    bool valid_word(std::string_view word){
+        const char *p = word.data();
+        std::size_t n = word.size();
+#ifdef WORD_SIMD
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        bool ok = true;
+        std::size_t done = 0;
+        if (avx2 && n >= 32)
+            done = valid_avx2(p, n, ok);
+        if (ok && n - done >= 16)
+            done += valid_sse2(p + done, n - done, ok);
+        if (!ok)
+            return false;
+        p += done;
+        n -= done;
+#endif
+        return valid_scalar(p, n);
+    }
+}
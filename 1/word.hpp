@@ -0,0 +1,20 @@
+#ifndef OOPPROG1_WORD_H
+#define OOPPROG1_WORD_H
+#include <array>
+#include <string_view>
+namespace Prog1 {
+    // символы, которых не может быть в названии города
+    constexpr std::string_view EVIL = "1234567890!@#{}$%^&*()[]/\\|=+ ";
+
+    // true для байтов из EVIL
+    constexpr std::array<bool, 256> EVIL_TABLE = []{
+        std::array<bool, 256> table{};
+        for (char c : EVIL)
+            table[static_cast<unsigned char>(c)] = true;
+        return table;
+    }();
+
+    // проверка слова по таблице; длинные слова проверяются SSE2/AVX2 блоками
+    bool valid_word(std::string_view word);
+}
+#endif //OOPPROG1_WORD_H
@@ -0,0 +1,197 @@
+#include "ColumnTable.hpp"
+#include "Resource.hpp"
+#include "Table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLUMN_SIMD 1
+#endif
+
+namespace prog2 {
+namespace {
+#ifdef COLUMN_SIMD
+  // uint -> double без потери старшего бита: сдвигаем в знаковый диапазон
+  // и возвращаем сдвиг уже в double
+  const double PRICE_BIAS = 2147483648.0;
+
+  // сумма (effi - cons) * 7 * price по первым n строкам, n кратно 2
+  double proffit_sse2(const double *cons, const double *effi, const uint *price, size_t n){
+    const __m128i flip = _mm_set1_epi32(INT32_MIN);
+    const __m128d bias = _mm_set1_pd(PRICE_BIAS), seven = _mm_set1_pd(7.0);
+    __m128d sum = _mm_setzero_pd();
+    for (size_t i = 0; i < n; i += 2){
+      __m128i p = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(price + i)), flip);
+      __m128d pd = _mm_add_pd(_mm_cvtepi32_pd(p), bias);
+      __m128d d = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(effi + i), _mm_loadu_pd(cons + i)), seven);
+      sum = _mm_add_pd(sum, _mm_mul_pd(d, pd));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1];
+  }
+
+  // то же, n кратно 4
+  __attribute__((target("avx2")))
+  double proffit_avx2(const double *cons, const double *effi, const uint *price, size_t n){
+    const __m128i flip = _mm_set1_epi32(INT32_MIN);
+    const __m256d bias = _mm256_set1_pd(PRICE_BIAS), seven = _mm256_set1_pd(7.0);
+    __m256d sum = _mm256_setzero_pd();
+    for (size_t i = 0; i < n; i += 4){
+      __m128i p = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(price + i)), flip);
+      __m256d pd = _mm256_add_pd(_mm256_cvtepi32_pd(p), bias);
+      __m256d d = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(effi + i), _mm256_loadu_pd(cons + i)), seven);
+      sum = _mm256_add_pd(sum, _mm256_mul_pd(d, pd));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+  // умножение первых n элементов на k; возвращает, сколько обработано
+  size_t scale_sse2(double *v, size_t n, double k){
+    const __m128d f = _mm_set1_pd(k);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+      _mm_storeu_pd(v + i, _mm_mul_pd(_mm_loadu_pd(v + i), f));
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  size_t scale_avx2(double *v, size_t n, double k){
+    const __m256d f = _mm256_set1_pd(k);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+      _mm256_storeu_pd(v + i, _mm256_mul_pd(_mm256_loadu_pd(v + i), f));
+    return i;
+  }
+
+  // переключается только из тестов, читается из любого потока
+  std::atomic<bool> sse2_forced{false};
+
+  bool has_avx2(){
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2 && !sse2_forced.load(std::memory_order_relaxed);
+  }
+#endif
+
+  void scale(std::vector<double> &column, double k){
+    size_t done = 0;
+#ifdef COLUMN_SIMD
+    done = has_avx2() ? scale_avx2(column.data(), column.size(), k) : scale_sse2(column.data(), column.size(), k);
+#endif
+    for (size_t i = done; i < column.size(); i++)
+      column[i] *= k;
+  }
+}
+
+  // объявлена только в tests/ColumnTableTest.hpp: в API библиотеки её нет
+  namespace detail {
+    void force_sse2([[maybe_unused]] bool on) noexcept{
+#ifdef COLUMN_SIMD
+      sse2_forced.store(on, std::memory_order_relaxed);
+#endif
+    }
+  }
+
+  ColumnTable::ColumnTable(const Resource *rhs, uint a){
+    // строки раскладываются в порядке имён, как в Table
+    std::vector<uint> order(a);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [rhs](uint x, uint y){
+      return rhs[x].getName() < rhs[y].getName();
+    });
+    // имена уникальны, как в Table: после сортировки повторы стоят рядом
+    for (uint i = 1; i < a; i++){
+      if (rhs[order[i - 1]].getName() == rhs[order[i]].getName()){
+        throw std::runtime_error("Resource already exists: " + rhs[order[i]].getName());
+      }
+    }
+    names.reserve(a);
+    cons.reserve(a);
+    effi.reserve(a);
+    price.reserve(a);
+    for (uint i : order){
+      names.push_back(rhs[i].getName());
+      cons.push_back(rhs[i].getCons());
+      effi.push_back(rhs[i].getEffi());
+      price.push_back(rhs[i].getPrice());
+    }
+  }
+
+  ColumnTable::ColumnTable(const Table &rhs) : ColumnTable(rhs.table, rhs.size){
+    // отложенное умножение таблицы применяется к столбцам сразу
+    if (rhs._scale != 1)
+      *this * rhs._scale;
+  }
+
+  uint ColumnTable::_lower(const std::string &name) const{
+    return std::lower_bound(names.begin(), names.end(), name) - names.begin();
+  }
+
+  Resource ColumnTable::get(const std::string &name) const{
+    uint i = _lower(name);
+    if (i == names.size() || names[i] != name){
+      throw std::runtime_error("Resource not found: " + name);
+    }
+    return Resource(names[i], cons[i], effi[i], price[i]);
+  }
+
+  ColumnTable &ColumnTable::operator+=(const Resource &rhs){
+    uint i = _lower(rhs.getName());
+    if (i != names.size() && names[i] == rhs.getName()){
+      throw std::runtime_error("Resource already exists: " + rhs.getName());
+    }
+    names.insert(names.begin() + i, rhs.getName());
+    cons.insert(cons.begin() + i, rhs.getCons());
+    effi.insert(effi.begin() + i, rhs.getEffi());
+    price.insert(price.begin() + i, rhs.getPrice());
+    return *this;
+  }
+
+  void ColumnTable::del_res(const std::string &name){
+    uint i = _lower(name);
+    if (i == names.size() || names[i] != name){
+      throw std::runtime_error("Resource not found: " + name);
+    }
+    names.erase(names.begin() + i);
+    cons.erase(cons.begin() + i);
+    effi.erase(effi.begin() + i);
+    price.erase(price.begin() + i);
+  }
+
+  double ColumnTable::proffit() const{
+    size_t n = cons.size(), done = 0;
+    double res = 0;
+#ifdef COLUMN_SIMD
+    if (has_avx2()){
+      done = n - n % 4;
+      res = proffit_avx2(cons.data(), effi.data(), price.data(), done);
+    }
+    else {
+      done = n - n % 2;
+      res = proffit_sse2(cons.data(), effi.data(), price.data(), done);
+    }
+#endif
+    for (size_t i = done; i < n; i++)
+      res += (effi[i] - cons[i]) * 7 * price[i];
+    return res;
+  }
+
+  ColumnTable &ColumnTable::operator*(double n){
+    scale(cons, n);
+    scale(effi, n);
+    return *this;
+  }
+
+  Table ColumnTable::toTable() const{
+    Table res;
+    for (uint i = 0; i < names.size(); i++)
+      res += Resource(names[i], cons[i], effi[i], price[i]);
+    return res;
+  }
+}
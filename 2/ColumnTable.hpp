@@ -0,0 +1,114 @@
+#ifndef COLUMN_TABLE
+#define COLUMN_TABLE
+
+#include <string>
+#include <vector>
+#include "Resource.hpp"
+#include "Table.hpp"
+
+namespace prog2 {
+    /**
+      @brief Таблица ресурсов, хранящая поля по столбцам.
+
+       Вариант Table для расчётов по всей таблице: потребление, эффективность
+      и цена лежат в отдельных массивах, поэтому proffit() и умножение
+      считаются векторными инструкциями (AVX2, если процессор его
+      поддерживает, иначе SSE2). Имена хранятся отдельным столбцом,
+      строки упорядочены по имени; как и в Table, имена не повторяются.
+     */
+    class ColumnTable{
+    private:
+        std::vector<std::string> names; ///< Столбец имён, по возрастанию.
+        std::vector<double> cons; ///< Столбец потребления.
+        std::vector<double> effi; ///< Столбец эффективности.
+        std::vector<uint> price; ///< Столбец цен.
+        uint _lower(const std::string &name) const; ///< Первая строка с именем не меньше name.
+
+    public:
+      /**
+          @brief Конструктор по умолчанию.
+
+          Создаёт пустую таблицу.
+         */
+        explicit ColumnTable() noexcept = default;
+
+        /**
+          @brief Конструктор с параметрами.
+
+          Раскладывает ресурсы массива по столбцам.
+          @param rhs Указатель на массив ресурсов.
+          @param a Количество ресурсов в массиве.
+          @throw Ошибка если в массиве повторяются имена.
+         */
+        ColumnTable(const Resource *rhs, uint a);
+
+        /**
+          @brief Конструктор из таблицы ресурсов.
+
+          @param rhs Таблица, ресурсы которой раскладываются по столбцам.
+         */
+        explicit ColumnTable(const Table &rhs);
+
+        /**
+          @brief Количество ресурсов в таблице.
+
+          @return Число строк.
+         */
+        uint getSize() const { return names.size(); };
+
+        /**
+          @brief Получение ресурса по имени.
+
+          Ресурс собирается из столбцов, поэтому возвращается копия.
+          @param name Имя ресурса.
+          @return Ресурс с указанным именем.
+          @throw Ошибка если ресурса с таким именем нет.
+         */
+        Resource get(const std::string &name) const;
+
+        /**
+          @brief Добавление ресурса в таблицу.
+
+          Вставляет ресурс на его место по имени.
+          @param rhs Ресурс, который нужно добавить.
+          @return Ссылка на текущую таблицу.
+          @throw Ошибка если ресурс с таким именем уже есть.
+         */
+        ColumnTable &operator += (const Resource &rhs);
+
+        /**
+          @brief Удаление ресурса по имени.
+
+          @param name Имя ресурса, который нужно удалить.
+          @throw Ошибка если ресурса с таким именем нет.
+         */
+        void del_res(const std::string &name);
+
+        /**
+          @brief Вычисление прибыли от всех ресурсов в таблице.
+
+          Суммирует векторно, поэтому порядок сложения, а с ним и последние
+          знаки результата, могут отличаться от Table::proffit().
+          @return Прибыль от всех ресурсов в таблице.
+         */
+        double proffit() const;
+
+        /**
+          @brief Умножение всех ресурсов на коэффициент.
+
+          Умножает потребление и эффективность всех ресурсов на заданное число.
+          @param n Коэффициент, на который нужно умножить.
+          @return Ссылка на текущую таблицу.
+         */
+        ColumnTable &operator * (double n);
+
+        /**
+          @brief Преобразование в обычную таблицу.
+
+          @return Таблица с теми же ресурсами.
+         */
+        Table toTable() const;
+    };
+}
+
+#endif
@@ -18,8 +18,8 @@ namespace prog2 {
     price = 0;
     */
   }
-  Resource::Resource(std::string name, double consumption, double efficiency, uint price): name(name), cons(consumption), effi(efficiency), price(price) {}
-  Resource::Resource(std::string name, uint price): name(name), cons(0.0), effi(0.0), price(price){}
+  Resource::Resource(std::string name, double consumption, double efficiency, uint price): name(std::move(name)), cons(consumption), effi(efficiency), price(price) {}
+  Resource::Resource(std::string name, uint price): name(std::move(name)), cons(0.0), effi(0.0), price(price){}
   Resource::Resource(const Resource &ob):name(ob.name), cons(ob.cons), effi(ob.effi), price(ob.price){}
 
   Resource Resource::operator + (const Resource &rhs) const{
@@ -58,7 +58,7 @@ namespace prog2 {
     double cons, effi;
     uint price;
     os >> name >> cons >> effi >> price;
-    rhs.setName(name);
+    rhs.setName(std::move(name));
     rhs.setCons(cons);
     rhs.setEffi(effi);
     rhs.setPrice(price);
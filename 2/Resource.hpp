@@ -4,6 +4,7 @@
 // #include <cstddef>
 #include <string>
 #include <iostream>
+#include <utility>
 
 namespace prog2 {
   /**
@@ -50,6 +51,30 @@ namespace prog2 {
       @param ob Объект, который будет скопирован.
      */
       Resource (const Resource &ob); 
+      /**
+      @brief Копирующий оператор присваивания.
+     
+      Нужен таблице, которая хранит ресурсы по значению.
+     
+      @param ob Объект, который будет скопирован.
+      @return Ссылка на текущий объект.
+     */
+      Resource &operator=(const Resource &ob) = default;
+      /**
+      @brief Перемещающий конструктор.
+     
+      Забирает строку названия у другого объекта без копирования.
+     
+      @param ob Объект, из которого перемещаются данные.
+     */
+      Resource(Resource &&ob) noexcept = default;
+      /**
+      @brief Перемещающий оператор присваивания.
+     
+      @param ob Объект, из которого перемещаются данные.
+      @return Ссылка на текущий объект.
+     */
+      Resource &operator=(Resource &&ob) noexcept = default;
       
 
 
@@ -57,9 +82,9 @@ namespace prog2 {
 	/**
       @brief Получает название ресурса.
      
-      @return Название ресурса.
+      @return Ссылка на название ресурса, действительная, пока жив объект.
      */
-      std::string getName() const {return name;};
+      const std::string &getName() const {return name;};
        /**
       @brief Получает потребление ресурса.
      
@@ -83,10 +108,10 @@ namespace prog2 {
       /**
       @brief Устанавливает название ресурса.
      
-      @param name Новое название ресурса.
+      @param name Новое название ресурса, перемещается в объект.
       @return Ссылку на текущий объект Resource для цепочного вызова методов.
      */
-    Resource &setName(std::string name) { (*this).name = name; return *this; };
+    Resource &setName(std::string name) { (*this).name = std::move(name); return *this; };
 
     /**
       @brief Устанавливает потребление ресурса.
@@ -5,75 +5,380 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 
 namespace prog2 {
+namespace {
+  std::runtime_error line_error(std::size_t line, const std::string &what){
+    return std::runtime_error("Line " + std::to_string(line) + ": " + what);
+  }
+
+  bool is_blank(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  void skip_blanks(std::string_view &s){
+    while (!s.empty() && is_blank(s.front()))
+      s.remove_prefix(1);
+  }
+
+  // число из начала s, за которым идёт пробел или конец строки
+  template<class T>
+  T parse_number(std::string_view &s, std::size_t line, const char *field){
+    skip_blanks(s);
+    T v;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || (end != s.data() + s.size() && !is_blank(*end)))
+      throw line_error(line, std::string("bad ") + field);
+    s.remove_prefix(end - s.data());
+    return v;
+  }
+
+  // строка "имя потребление эффективность цена"
+  Resource parse_row(std::string_view s, std::size_t line){
+    skip_blanks(s);
+    std::size_t end = 0;
+    while (end < s.size() && !is_blank(s[end]))
+      end++;
+    std::string name(s.substr(0, end));
+    s.remove_prefix(end);
+    double cons = parse_number<double>(s, line, "consumption");
+    double effi = parse_number<double>(s, line, "efficiency");
+    uint price = parse_number<uint>(s, line, "price");
+    skip_blanks(s);
+    if (!s.empty())
+      throw line_error(line, "unexpected data after price");
+    return Resource(std::move(name), cons, effi, price);
+  }
+
+  uint name_hash(const std::string &name){
+    return static_cast<uint>(std::hash<std::string>{}(name));
+  }
+
+  // первые 8 байт имени числом: порядок чисел совпадает с порядком строк,
+  // пока префиксы различаются
+  std::uint64_t name_prefix(const std::string &name){
+    std::uint64_t p = 0;
+    for (std::size_t i = 0; i < 8; i++)
+      p = p << 8 | (i < name.size() ? static_cast<unsigned char>(name[i]) : 0);
+    return p;
+  }
+
+  bool blank_line(std::string_view s){
+    skip_blanks(s);
+    return s.empty();
+  }
+
+  // сколько мест operator>> резервирует до чтения строк
+  const uint READ_CHUNK = 1024;
+
+  // количество ресурсов в заголовке
+  uint parse_count(std::string_view s, std::size_t line){
+    uint count = parse_number<uint>(s, line, "resource count");
+    skip_blanks(s);
+    if (!s.empty())
+      throw line_error(line, "unexpected data after resource count");
+    return count;
+  }
+}
+
 uint Table::_correct_size(uint n){
     return (n - n % 2) * 2;
   }
 
-  void Table::_sort(){
-    std::sort(table, table + size, [](const Resource *a, const Resource *b) {
-        return *b < *a;
+  void Table::_sort(uint from, uint to){
+    // сортируются пары (префикс имени, позиция), к самим строкам
+    // обращаемся только при равных префиксах
+    struct Key { std::uint64_t prefix; uint slot; };
+    std::vector<Key> keys;
+    keys.reserve(to - from);
+    for (uint i = from; i < to; i++)
+      keys.push_back({name_prefix(table[i].getName()), i});
+    std::sort(keys.begin(), keys.end(), [this](const Key &a, const Key &b) {
+        if (a.prefix != b.prefix)
+          return a.prefix < b.prefix;
+        return table[b.slot] < table[a.slot];
     });
+    for (std::size_t i = 1; i < keys.size(); i++){
+      const std::string &name = table[keys[i].slot].getName();
+      if (keys[i].prefix == keys[i - 1].prefix && table[keys[i - 1].slot].getName() == name)
+        throw std::runtime_error("Resource already exists: " + name);
+    }
+    for (const Key &k : keys)
+      order.push_back(k.slot);
   }
 
-  Table::Table(const Table &other) : _allocated(other._allocated), size(other.size){
-    table = new Resource*[_allocated];
-    for(uint i=0; i < size; ++i){
-      table[i] = new Resource(*other.table[i]);
+  uint Table::_find(const std::string &name) const{
+    if (index.empty())
+      return EMPTY;
+    uint mask = index.size() - 1, h = name_hash(name);
+    for (uint c = h & mask; index[c].slot != EMPTY; c = (c + 1) & mask){
+      if (index[c].hash == h && table[index[c].slot].getName() == name)
+        return c;
     }
+    return EMPTY;
   }
 
-  Table::Table(Resource *rhs, uint a){
-    _allocated = _correct_size(a);
-    size = a;
-    table = new Resource*[_allocated];
-    for(uint i = 0; i<a; i++){
-      Resource pr = rhs[i];
+  void Table::_rehash(uint n){
+    // заполнено не больше половины ячеек, их число - степень двойки
+    std::size_t cells = 8;
+    while (cells < 2 * std::size_t(n))
+      cells *= 2;
+    if (cells <= index.size())
+      return;
+    std::vector<Cell> old(cells, Cell{EMPTY, 0});
+    old.swap(index);
+    uint mask = cells - 1;
+    for (const Cell &e : old){
+      if (e.slot == EMPTY)
+        continue;
+      uint c = e.hash & mask;
+      while (index[c].slot != EMPTY)
+        c = (c + 1) & mask;
+      index[c] = e;
+    }
+  }
 
-      Resource *tmp = new Resource(pr.getName(), pr.getCons(), pr.getEffi(), pr.getPrice());
-      table[i] = tmp;
+  void Table::_index_add(uint slot){
+    // записей в индексе не больше, чем ресурсов до table[slot] включительно
+    _rehash(std::max(size, slot) + 1);
+    uint mask = index.size() - 1, h = name_hash(table[slot].getName());
+    uint c = h & mask;
+    while (index[c].slot != EMPTY)
+      c = (c + 1) & mask;
+    index[c] = {slot, h};
+  }
+
+  void Table::_index_erase(uint cell){
+    // сдвигаем назад следующие ячейки цепочки, которым освободившееся
+    // место ближе к их домашней ячейке, чтобы поиск не обрывался на дыре
+    uint mask = index.size() - 1;
+    for (uint c = (cell + 1) & mask; index[c].slot != EMPTY; c = (c + 1) & mask){
+      uint home = index[c].hash & mask;
+      if (((c - home) & mask) >= ((c - cell) & mask)){
+        index[cell] = index[c];
+        cell = c;
+      }
     }
-    _sort();
+    index[cell].slot = EMPTY;
   }
 
-  Resource& Table::operator[](const std::string& name) {
-    int left = 0;
-    int right = size - 1;
+  void Table::_compact(){
+    if (_dead == 0)
+      return;
+    std::erase(order, EMPTY);
+    _dead = 0;
+    _rerank(0);
+  }
 
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        
-        if (table[mid]->getName() == name) {
-            return *table[mid];
-        }
-        else if (table[mid]->getName() < name) {
-            left = mid + 1;
-        }
-        else {
-            right = mid - 1; 
-        }
+  void Table::_rerank(uint from){
+    if (rank.size() < size)
+      rank.resize(size);
+    for (uint k = from; k < order.size(); k++){
+      if (order[k] != EMPTY)
+        rank[order[k]] = k;
+    }
+  }
+
+  uint Table::_position(const std::string &name) const{
+    return std::lower_bound(order.begin(), order.end(), name, [this](uint slot, const std::string &n) {
+        return table[slot].getName() < n;
+    }) - order.begin();
+  }
+
+  void Table::Sum::add(double x){
+    double t = sum + x;
+    if (std::fabs(sum) >= std::fabs(x))
+      c += (sum - t) + x;
+    else
+      c += (x - t) + sum;
+    sum = t;
+  }
+
+  void Table::_apply(){
+    if (_scale == 1)
+      return;
+    // ресурсы всё равно обходятся, поэтому сумма считается заново:
+    // так не копится ошибка от умножений и вычитаний
+    _proffit = Sum();
+    for (uint i = 0; i < size; i++){
+      Resource &r = table[i];
+      r.setCons(r.getCons() * _scale).setEffi(r.getEffi() * _scale);
+      _proffit.add(r.proffit());
+    }
+    _scale = 1;
+  }
+
+  Resource &Table::_write(uint slot){
+    // новое значение пишется как есть, поэтому множитель применяется заранее
+    _apply();
+    _proffit.add(-table[slot].proffit());
+    return table[slot];
+  }
+
+  Table::Ref &Table::Ref::setName(std::string name){
+    tab->rename(getName(), std::move(name));
+    return *this;
+  }
+
+  Table::Ref &Table::Ref::setCons(double cons){
+    tab->_proffit.add(tab->_write(slot).setCons(cons).proffit());
+    return *this;
+  }
+
+  Table::Ref &Table::Ref::setEffi(double effi){
+    tab->_proffit.add(tab->_write(slot).setEffi(effi).proffit());
+    return *this;
+  }
+
+  Table::Ref &Table::Ref::setPrice(uint price){
+    tab->_proffit.add(tab->_write(slot).setPrice(price).proffit());
+    return *this;
+  }
+
+  Table::Ref::operator Resource() const{
+    return Resource(getName(), getCons(), getEffi(), getPrice());
+  }
+
+  void Table::_grow(uint n, uint pending){
+    Resource *tmp = new Resource[n];
+    std::move(table, table + size + pending, tmp);
+    delete[] table;
+    table = tmp;
+    _allocated = n;
+  }
+
+  Table::Table(const Table &other) : _allocated(other._allocated), size(other.size), index(other.index), order(other.order), rank(other.rank), _dead(other._dead), _scale(other._scale), _proffit(other._proffit){
+    table = _allocated ? new Resource[_allocated] : nullptr;
+    std::copy(other.table, other.table + size, table);
+  }
+
+  Table::Table(Resource *rhs, uint a){
+    // при нечётном a _correct_size даёт меньше a
+    _allocated = std::max(_correct_size(a), a);
+    size = 0;
+    table = _allocated ? new Resource[_allocated] : nullptr;
+    try {
+      insert(rhs, a);
     }
+    catch(...){
+      delete[] table;
+      throw;
+    }
+  }
 
+  void Table::_reserve(uint n, uint pending){
+    // пустая таблица, как и в +=, получает хотя бы два места
+    if (n > _allocated)
+      _grow(std::max({_correct_size(_allocated), n, 2u}), pending);
+  }
+
+  Table &Table::insert(const Resource *rhs, uint a){
+    _reserve(size + a);
+    std::copy(rhs, rhs + a, table + size);
+    _commit(a);
+    return *this;
+  }
+
+  void Table::_commit(uint a){
+    // новые ресурсы лежат за концом таблицы; их позиции упорядочиваются
+    // в хвосте order и проверяются до того, как войдут в таблицу
+    _compact();
+    uint from = order.size();
+    _sort(size, size + a);
+    for (uint i = size; size > 0 && i < size + a; i++){
+      const std::string &name = table[i].getName();
+      if (_find(name) != EMPTY){
+        order.resize(from);
+        throw std::runtime_error("Resource already exists: " + name);
+      }
+    }
+    // новые ресурсы не умножены, поэтому старые пересчитываются,
+    // но только когда все проверки пройдены
+    _apply();
+    _rehash(size + a);
+    for (uint i = 0; i < a; i++){
+      _index_add(size + i);
+      _proffit.add(table[size + i].proffit());
+    }
+    size += a;
+    std::inplace_merge(order.begin(), order.begin() + from, order.end(), [this](uint x, uint y) {
+        return table[y] < table[x];
+    });
+    _rerank(0);
+  }
+
+  Table &Table::load(std::istream &is){
+    // поток читается целиком, без разбора по словам
+    std::string text;
+    std::vector<char> block(1 << 20);
+    while (is.read(block.data(), block.size()) || is.gcount() > 0)
+      text.append(block.data(), is.gcount());
+    is.clear(std::ios::eofbit);
+
+    std::string_view rest(text);
+    std::size_t line = 0;
+    bool header = false;
+    uint count = 0, added = 0;
+    while (!rest.empty()){
+      std::size_t end = rest.find('\n');
+      std::string_view s = rest.substr(0, end);
+      rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+      line++;
+      if (blank_line(s))
+        continue;
+      if (!header){
+        header = true;
+        count = parse_count(s, line);
+        // заявленное количество не может быть больше оставшихся строк
+        uint lines = std::min<std::size_t>(count, std::count(rest.begin(), rest.end(), '\n') + 1);
+        if (lines > std::numeric_limits<uint>::max() - size)
+          throw line_error(line, "too many resources");
+        _reserve(size + lines);
+        continue;
+      }
+      if (added == count)
+        throw line_error(line, "more than " + std::to_string(count) + " resources");
+      table[size + added++] = parse_row(s, line);
+    }
+    if (!header)
+      throw std::runtime_error("Empty input");
+    if (added < count)
+      throw line_error(line, "expected " + std::to_string(count) + " resources, got " + std::to_string(added));
+    _commit(added);
+    return *this;
+  }
+
+  Table::Ref Table::operator[](const std::string& name) {
+    uint cell = _find(name);
+    if (cell != EMPTY)
+      return Ref(this, index[cell].slot);
     throw std::runtime_error("Resource not found: " + name);
   }
 
   Table &Table::operator *(double n){
-    // Table res(*this);
-    Resource **tmp = new Resource*[this->_allocated];
-    for (uint i=0; i < this->size; i++){
-      tmp[i] = new Resource((*this->table[i]) * n);
-      delete this->table[i];
-    }
-    delete[] this->table;
-    this->table = tmp;
+    // proffit линеен по потреблению и эффективности, поэтому ресурсы
+    // можно не трогать до первого обращения к ним
+    _scale *= n;
     return *this;
   }
 
   Table::Table(Table &&other) noexcept 
-    : _allocated(other._allocated), size(other.size), table(other.table) {
+    : _allocated(other._allocated), size(other.size), table(other.table),
+      index(std::move(other.index)), order(std::move(other.order)), rank(std::move(other.rank)), _dead(other._dead),
+      _scale(other._scale), _proffit(other._proffit) {
     // Обнуляем перемещаемый объект
+    other._dead = 0;
+    other._scale = 1;
+    other._proffit = Sum();
     other._allocated = 0;
     other.size = 0;
     other.table = nullptr;
@@ -85,18 +390,19 @@ uint Table::_correct_size(uint n){
         }
 
         // Clean up existing resources
-        for (uint i = 0; i < size; ++i) {
-            delete table[i];
-        }
         delete[] table;
 
         // Copy data from other
         _allocated = other._allocated;
         size = other.size;
-        table = new Resource*[size];
-        for (uint i = 0; i < size; ++i) {
-            table[i] = new Resource(*other.table[i]); // Deep copy of each Resource
-        }
+        table = _allocated ? new Resource[_allocated] : nullptr;
+        std::copy(other.table, other.table + size, table);
+        index = other.index;
+        order = other.order;
+        rank = other.rank;
+        _dead = other._dead;
+        _scale = other._scale;
+        _proffit = other._proffit;
 
         return *this;
   }
@@ -109,16 +415,22 @@ uint Table::_correct_size(uint n){
     }
 
     // Освобождаем текущие ресурсы
-    for (uint i=0;i<size;i++){
-    delete table[i];
-    }
     delete[] table;
     // Перемещаем данные из другого объекта
     size = other.size;
     _allocated = other._allocated;
     table = other.table;
+    index = std::move(other.index);
+    order = std::move(other.order);
+    rank = std::move(other.rank);
+    _dead = other._dead;
+    _scale = other._scale;
+    _proffit = other._proffit;
 
     // Обнуляем перемещаемый объект
+    other._dead = 0;
+    other._scale = 1;
+    other._proffit = Sum();
     other.size = 0;
     other._allocated = 0;
     other.table = nullptr;
@@ -129,22 +441,31 @@ uint Table::_correct_size(uint n){
 
 
   Table& Table::operator+=(const Resource &rhs){
-    if (this->_allocated == 0){
-      this->_allocated = 2;
-      delete[] this->table;
-      this->table = new Resource*[this->_allocated];
-    }
+    return *this += Resource(rhs);
+  }
 
-    if (this->size == this->_allocated){
-      Resource **tmp = new Resource*[_correct_size(this->_allocated)];
-      for (uint i=0; i<this->size; i++)
-        tmp[i] = table[i];
-      delete[] this->table;
-      this->table = tmp;
-      this->_allocated = _correct_size(this->_allocated);
-    }
-    this->table[this->size] = new Resource(rhs);
+  Table &Table::emplace(std::string name, double cons, double effi, uint price){
+    return *this += Resource(std::move(name), cons, effi, price);
+  }
+
+  Table& Table::operator+=(Resource &&rhs){
+    if (_find(rhs.getName()) != EMPTY)
+      throw std::runtime_error("Resource already exists: " + rhs.getName());
+    _apply();
+    if (this->_allocated == 0)
+      _grow(2);
+    if (this->size == this->_allocated)
+      _grow(std::max(_correct_size(this->_allocated), this->size + 1));
+    this->table[this->size] = std::move(rhs);
+    const Resource &added = this->table[this->size];
+    _proffit.add(added.proffit());
+    _index_add(this->size);
+    // двоичный поиск места и сдвиг хвоста позиций, без пересортировки
+    _compact();
+    uint at = _position(added.getName());
+    order.insert(order.begin() + at, this->size);
     this->size++;
+    _rerank(at);
     return *this;
     
   }
@@ -158,48 +479,59 @@ uint Table::_correct_size(uint n){
     return full;
   }
 
-  void Table::del_res(std::string name){
-    for (uint i=0; i < this->size; ++i){
-      if ((this->table)[i]->getName() == name){
-        delete (this->table)[i];
-
-        for (uint j=i; j < this->size - 1; ++j){
-          (this->table)[j] = (this->table)[j + 1];
-        }
-
-        this->size--;
-        this->table[this->size] = nullptr;
-        return;
-      }
+  void Table::del_res(const std::string &name){
+    uint cell = _find(name);
+    if (cell == EMPTY)
+      throw std::runtime_error("Resource not found: " + name);
+    uint i = index[cell].slot;
+    _index_erase(cell);
+    // в order остаётся пометка, сдвига хвоста нет
+    order[rank[i]] = EMPTY;
+    _dead++;
+    _proffit.add(-this->table[i].proffit());
+    // на место удалённого переезжает последний ресурс
+    this->size--;
+    if (i != this->size){
+      const std::string &last = this->table[this->size].getName();
+      order[rank[this->size]] = i;
+      rank[i] = rank[this->size];
+      index[_find(last)].slot = i;
+      this->table[i] = std::move(this->table[this->size]);
     }
-    throw std::runtime_error("Resource not found: " + name);
+    this->table[this->size] = Resource();
+    // пометок больше, чем ресурсов: сжатие за O(n) раз в n удалений
+    if (_dead > this->size)
+      _compact();
   }
 
-  bool Table::rename(std::string oname, std::string nname){
-    try {
-      Resource tmp = (*this)[oname];
-      (*this)[oname].setName(nname);
-    } 
-    catch(...){
+  bool Table::rename(const std::string &oname, std::string nname){
+    uint cell = _find(oname);
+    if (cell == EMPTY)
       throw std::runtime_error("Not such resource");
-    }
-    this->_sort();
-    return 0;
-    
+    if (oname == nname)
+      return true;
+    if (_find(nname) != EMPTY)
+      throw std::runtime_error("Resource already exists: " + nname);
+    uint i = index[cell].slot;
+    _index_erase(cell);
+    _compact();
+    uint from = rank[i];
+    order.erase(order.begin() + from);
+    // oname может быть ссылкой на это же имя в таблице, дальше он не нужен
+    table[i].setName(std::move(nname));
+    _index_add(i);
+    uint at = _position(table[i].getName());
+    order.insert(order.begin() + at, i);
+    _rerank(std::min(from, at));
+    return true;
+
   }
   Table :: ~Table(){
-    for (uint i=0; i<size; i++){
-      delete table[i];
-    }
     delete[] table;
   }
 
   double Table::proffit() const{
-    double res = 0;
-    for (uint i=0; i<size; i++){
-      res += table[i]->proffit();
-    }
-    return res;
+    return _proffit.value() * _scale;
   }
 /*
   std::ostream& operator << (std::ostream &os, Table &tab){
@@ -224,21 +556,41 @@ uint Table::_correct_size(uint n){
   */
 
 std::ostream& operator<<(std::ostream &os, Table &tab) {
-        for (uint i = 0; i < tab.size; i++) {
-            os << *(tab.table[i]) << std::endl; // Доступ к приватному полю table
+        tab._apply();
+        for (uint i : tab.order) {
+            if (i != Table::EMPTY)
+                os << tab.table[i] << std::endl; // Доступ к приватному полю table
         }
         return os;
     }
 
     std::istream& operator>>(std::istream &is, Table &tab) {
-        // Сначала запрашиваем, сколько ресурсов нужно добавить
-        uint size = 0;
-        is >> size;
-        for (uint i = 0; i < size; i++) {
-            Resource tmp;
-            is >> tmp; // Предполагается, что у Resource также есть перегруженный оператор >>
-            tab += tmp; // Доступ к методу добавления ресурса
+        // заголовок - первая непустая строка, в ней только количество
+        std::string s;
+        std::size_t line = 0;
+        do {
+            if (!std::getline(is, s))
+                return is;
+            line++;
+        } while (blank_line(s));
+        uint size = parse_count(s, line);
+        if (size > std::numeric_limits<uint>::max() - tab.size)
+            throw line_error(line, "too many resources");
+        // ресурсы пишутся сразу за концом таблицы и добавляются все вместе;
+        // заявленному количеству не верим и растим массив по мере чтения
+        tab._reserve(tab.size + std::min(size, READ_CHUNK));
+        uint added = 0;
+        while (added < size && std::getline(is, s)) {
+            line++;
+            if (blank_line(s))
+                continue;
+            if (tab.size + added == tab._allocated)
+                tab._reserve(tab.size + added + 1, added);
+            tab.table[tab.size + added++] = parse_row(s, line);
         }
+        if (added < size)
+            throw line_error(line, "expected " + std::to_string(size) + " resources, got " + std::to_string(added));
+        tab._commit(added);
         return is;
     }
 
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <iostream>
+#include <climits>
+#include <vector>
 #include "Resource.hpp"
 
 namespace prog2 {
@@ -11,15 +13,140 @@ namespace prog2 {
      
        Класс управляет коллекцией ресурсов и предоставляет методы для
       добавления, удаления и изменения ресурсов, а также для получения
-      информации о них.
+      информации о них. Ресурсы ищутся по имени через хеш-индекс, а порядок
+      по возрастанию имён поддерживается отдельным массивом позиций.
+      Умножение на коэффициент откладывается и применяется к ресурсам только
+      тогда, когда они нужны сами по себе. Суммарная прибыль хранится и
+      пересчитывается при каждом изменении, поэтому proffit() работает за O(1).
      */
     class Table{
+    friend class ColumnTable;
+    public:
+        /**
+          @brief Ссылка на ресурс таблицы.
+
+           Возвращается оператором []. Чтение учитывает отложенное умножение
+          таблицы, а запись идёт через таблицу, чтобы та обновила суммарную
+          прибыль и индекс имён. Ссылка действительна до удаления любого
+          ресурса из таблицы.
+         */
+        class Ref{
+        friend class Table;
+        private:
+            Table *tab; ///< Таблица, в которой лежит ресурс.
+            uint slot; ///< Позиция ресурса в массиве таблицы.
+            Ref(Table *tab, uint slot) : tab(tab), slot(slot) {};
+
+        public:
+            /**
+              @brief Получает название ресурса.
+
+              @return Ссылка на название ресурса.
+             */
+            const std::string &getName() const { return tab->table[slot].getName(); };
+            /**
+              @brief Получает потребление ресурса с учётом множителя таблицы.
+
+              @return Потребление ресурса.
+             */
+            double getCons() const { return tab->table[slot].getCons() * tab->_scale; };
+            /**
+              @brief Получает эффективность ресурса с учётом множителя таблицы.
+
+              @return Эффективность ресурса.
+             */
+            double getEffi() const { return tab->table[slot].getEffi() * tab->_scale; };
+            /**
+              @brief Получает цену ресурса.
+
+              @return Цена ресурса.
+             */
+            uint getPrice() const { return tab->table[slot].getPrice(); };
+            /**
+              @brief Считает проффит ресурса.
+
+              @return Число в формате double.
+             */
+            double proffit() const { return tab->table[slot].proffit() * tab->_scale; };
+
+            /**
+              @brief Переименовывает ресурс через Table::rename.
+
+              @param name Новое название ресурса.
+              @return Ссылку на текущий объект для цепочного вызова методов.
+              @throw Ошибка если ресурс с таким именем уже есть.
+             */
+            Ref &setName(std::string name);
+            /**
+              @brief Устанавливает потребление ресурса.
+
+              @param cons Новое потребление ресурса.
+              @return Ссылку на текущий объект для цепочного вызова методов.
+             */
+            Ref &setCons(double cons);
+            /**
+              @brief Устанавливает эффективность ресурса.
+
+              @param effi Новая эффективность ресурса.
+              @return Ссылку на текущий объект для цепочного вызова методов.
+             */
+            Ref &setEffi(double effi);
+            /**
+              @brief Устанавливает цену ресурса.
+
+              @param price Новая цена ресурса.
+              @return Ссылку на текущий объект для цепочного вызова методов.
+             */
+            Ref &setPrice(uint price);
+
+            /**
+              @brief Копия ресурса с учётом множителя таблицы.
+             */
+            operator Resource() const;
+            /**
+              @brief Оператор равенства, как у Resource, сравнивает имена.
+
+              @param rhs Ресурс для сравнения.
+              @return true, если имена совпадают; иначе false.
+             */
+            bool operator==(const Resource &rhs) const { return rhs.getName() == getName(); };
+        };
+
     private:
         uint _allocated; ///< Количество выделенной памяти для ресурсов.
         uint _correct_size(uint); ///< Проверяет корректный размер.
-        void _sort(); ///< Сортирует таблицу ресурсов.
+        void _sort(uint from, uint to); ///< Дописывает в order позиции [from, to) по возрастанию имён, проверяя их на повторы.
         uint size; ///< Текущий размер таблицы.
-        Resource **table; ///< Указатель на массив ресурсов.
+        Resource *table; ///< Массив ресурсов, хранящихся по значению подряд.
+        void _grow(uint n, uint pending = 0); ///< Расширяет массив до n ресурсов, сохраняя pending записанных за концом.
+        void _reserve(uint n, uint pending = 0); ///< Расширяет массив, если в нём меньше n мест.
+        void _commit(uint a); ///< Включает в таблицу a ресурсов, записанных за её концом.
+        /// Ячейка хеш-индекса: позиция ресурса в table и хеш его имени.
+        struct Cell { uint slot; uint hash; };
+        static constexpr uint EMPTY = UINT_MAX; ///< Свободная ячейка индекса и "не найдено" для _find.
+        std::vector<Cell> index; ///< Имя ресурса -> его позиция в table, открытая адресация.
+        uint _find(const std::string &name) const; ///< Ячейка index с этим именем или EMPTY.
+        void _index_add(uint slot); ///< Добавляет в индекс ресурс table[slot].
+        void _index_erase(uint cell); ///< Освобождает ячейку index.
+        void _rehash(uint n); ///< Готовит индекс к n ресурсам.
+        std::vector<uint> order; ///< Позиции ресурсов в table по возрастанию имён; EMPTY - удалённый.
+        std::vector<uint> rank; ///< Место ресурса table[slot] в order.
+        uint _dead = 0; ///< Сколько ячеек order помечено EMPTY.
+        void _compact(); ///< Убирает из order удалённые ячейки.
+        void _rerank(uint from); ///< Пересчитывает rank для order начиная с from.
+        uint _position(const std::string &name) const; ///< Место имени в order без удалённых ячеек.
+        double _scale = 1; ///< Отложенный множитель потребления и эффективности всех ресурсов.
+        void _apply(); ///< Применяет _scale к ресурсам и сбрасывает его в 1.
+        /// Сумма с компенсацией ошибки округления (Ноймайер): вычитание большого
+        /// слагаемого не теряет накопленные рядом с ним малые.
+        struct Sum {
+            double sum = 0; ///< Обычная сумма.
+            double c = 0; ///< Потерянные при сложении младшие разряды.
+            void add(double x); ///< Прибавляет x.
+            double value() const { return sum + c; }; ///< Сумма с поправкой.
+        };
+        Sum _proffit; ///< Сумма прибыли ресурсов без учёта _scale.
+        Resource &_write(uint slot); ///< Готовит ресурс к изменению: вычитает его прибыль из _proffit.
 
     public:
 
@@ -77,18 +204,20 @@ namespace prog2 {
           Инициализирует таблицу ресурсами из массива.
           @param rhs Указатель на массив ресурсов.
           @param a Количество ресурсов в массиве.
+          @throw Ошибка если в массиве повторяются имена.
          */
         Table(Resource *rhs, uint a);
 
         /**
           @brief Получение ресурса по имени.
          
-          Позволяет получить доступ к ресурсу по его имени.
+          Позволяет получить доступ к ресурсу по его имени за O(1).
+          Изменения через возвращаемую ссылку учитываются в proffit().
           @param name Имя ресурса.
           @return Ссылка на ресурс с указанным именем.
           @throw Ошибка если ресурса с таким именем нет.
          */
-        Resource& operator [] (const std::string &name);
+        Ref operator [] (const std::string &name);
 
         /**
           @brief Добавление ресурса в таблицу.
@@ -96,12 +225,70 @@ namespace prog2 {
           Добавляет ресурс в таблицу и обновляет ее состояние.
           @param rhs Ресурс, который нужно добавить.
           @return Ссылка на текущую таблицу.
+          @throw Ошибка если ресурс с таким именем уже есть.
          */
         Table &operator += (const Resource &rhs);
 
+        /**
+          @brief Добавление ресурса в таблицу перемещением.
+
+          Название ресурса переезжает в таблицу без копирования.
+          @param rhs Ресурс, который нужно добавить.
+          @return Ссылка на текущую таблицу.
+          @throw Ошибка если ресурс с таким именем уже есть.
+         */
+        Table &operator += (Resource &&rhs);
+
+        /**
+          @brief Создание ресурса прямо в таблице.
+
+          То же, что += Resource(name, cons, effi, price), но без
+          промежуточной копии названия.
+          @param name Название ресурса.
+          @param cons Потребление ресурса.
+          @param effi Эффективность ресурса.
+          @param price Цена ресурса.
+          @return Ссылка на текущую таблицу.
+          @throw Ошибка если ресурс с таким именем уже есть.
+         */
+        Table &emplace(std::string name, double cons, double effi, uint price);
+
+        /**
+          @brief Добавление массива ресурсов в таблицу.
+
+          Память выделяется один раз, а новые ресурсы упорядочиваются одной
+          сортировкой и сливаются с уже имеющимися, вместо вставки по одному.
+          При ошибке ресурсы таблицы не меняются, но выделенная под массив
+          память остаётся за таблицей.
+          @param rhs Указатель на массив ресурсов.
+          @param a Количество ресурсов в массиве.
+          @return Ссылка на текущую таблицу.
+          @throw Ошибка если имя повторяется в массиве или уже есть в таблице.
+         */
+        Table &insert(const Resource *rhs, uint a);
+
+        /**
+          @brief Быстрая загрузка ресурсов из потока.
+
+          Читает поток до конца большими блоками. Формат тот же, что у
+          оператора >>: в первой непустой строке количество ресурсов, дальше
+          по ресурсу на строку, "имя потребление эффективность цена".
+          Пустые строки пропускаются. Числа разбираются std::from_chars,
+          память под все ресурсы выделяется один раз, а добавляются они
+          одним вызовом, как в insert. При ошибке ресурсы таблицы не
+          меняются, но память, выделенная под заявленные ресурсы, остаётся
+          за таблицей.
+          @param is Входной поток, читается до конца.
+          @return Ссылка на текущую таблицу.
+          @throw Ошибка с номером строки, если строка не разбирается,
+          ресурсов больше или меньше заявленного или имя повторяется.
+         */
+        Table &load(std::istream &is);
+
         /**
           @brief Вычисление прибыли от всех ресурсов в таблице.
          
+          Сумма поддерживается при изменениях таблицы, вызов работает за O(1).
           @return Прибыль от всех ресурсов в таблице.
          */
         double proffit() const;
@@ -109,7 +296,10 @@ namespace prog2 {
         /**
           @brief Умножение всех ресурсов на коэффициент.
          
-          Умножает прибыль всех ресурсов на заданное число.
+          Умножает прибыль всех ресурсов на заданное число за O(1):
+          множитель запоминается и учитывается в proffit() и при чтении
+          через [], а к самим ресурсам применяется при записи, добавлении
+          и выводе.
           @param n Коэффициент, на который нужно умножить прибыль.
           @return Ссылка на текущую таблицу.
          */
@@ -118,21 +308,25 @@ namespace prog2 {
         /**
           @brief Удаление ресурса по имени.
          
-          Удаляет ресурс с указанным именем из таблицы.
+          Удаляет ресурс с указанным именем из таблицы за амортизированное
+          O(1): на его место переносится последний ресурс, а в порядке имён
+          остаётся пометка, которая убирается, когда пометок больше, чем
+          ресурсов, или перед следующей вставкой.
           @param name Имя ресурса, который нужно удалить.
           @throw Ошибка если ресурса с таким именем нет.
          */
-        void del_res(std::string name);      
+        void del_res(const std::string &name);      
         /**
           @brief Переименование ресурса в таблице.
          
-          Переименовывает ресурс с одного имени на другое.
+          Переименовывает ресурс с одного имени на другое за O(n):
+          ресурс переставляется в порядке имён.
           @param oname Старое имя ресурса.
           @param nname Новое имя ресурса.
           @return true Если переименование прошло успешно, иначе false.
-          @throw Ошибка если ресурса с таким именем нет.
+          @throw Ошибка если ресурса с таким именем нет или новое имя занято.
          */
-        bool rename(std::string oname, std::string nname);
+        bool rename(const std::string &oname, std::string nname);
 
         /**
           @brief енумератор для возвращаемых значений функции check_size
@@ -156,6 +350,14 @@ namespace prog2 {
       @brief Оператор ввода для класса Table.
      
       Позволяет загружать данные о ресурсах из потока ввода в таблицу.
+      Читает строку с количеством ресурсов и ровно столько непустых строк
+      после неё, разбирая их так же, как load(), поэтому из потока можно
+      читать несколько таблиц подряд. Память выделяется по мере чтения,
+      а не сразу под заявленное количество. При ошибке ресурсы таблицы не
+      меняются, а выделенная память остаётся за таблицей.
+      @throw Ошибка с номером строки от начала чтения, если строка не
+      разбирается, после количества есть данные, строк меньше заявленного
+      или имя повторяется.
       @param is Входной поток данных.
       @param rhs Объект класса Table, в который будут загружены данные.
       @return Ссылка на входной поток данных.
@@ -166,7 +368,8 @@ namespace prog2 {
       /**
       @brief Оператор вывода для класса Table.
      
-      Позволяет выводить данные о ресурсах из таблицы в выходной поток.
+      Позволяет выводить данные о ресурсах из таблицы в выходной поток
+      в порядке возрастания имён.
       @param os Выходной поток данных.
       @param rhs Объект класса Table, данные которого будут выведены.
       @return Ссылка на выходной поток данных.
@@ -0,0 +1 @@
+../ColumnTable.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../ColumnTable.hpp
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef COLUMN_TABLE_TEST
+#define COLUMN_TABLE_TEST
+
+// Служебные функции ColumnTable, нужные только тестам; в ColumnTable.hpp
+// их нет, чтобы они не попали в API библиотеки.
+
+namespace prog2::detail {
+    /**
+      @brief Принудительный выбор SSE2 вместо AVX2.
+
+      Позволяет проверить оба векторных пути на процессоре с AVX2.
+      Без поддержки SIMD ничего не делает.
+      @param on true - всегда SSE2, false - выбор по процессору.
+     */
+    void force_sse2(bool on) noexcept;
+}
+
+#endif
@@ -3,11 +3,36 @@
 
 #include "Resource.hpp"
 #include "Table.hpp"
+#include "ColumnTable.hpp"
+#include "ColumnTableTest.hpp"
 
+#include <cstdint>
+#include <cstdlib>
+#include <new>
 #include <sstream>
+#include <vector>
 #include <catch2/catch_all.hpp>
 using namespace prog2;
 
+// считаем выделения памяти, чтобы проверять отсутствие лишних копий строк
+namespace {
+  std::size_t allocations = 0;
+}
+
+void *operator new(std::size_t n){
+  allocations++;
+  if (void *p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept{
+  allocations++;
+  return std::malloc(n ? n : 1);
+}
+// без noinline GCC видит free рядом с new и ложно предупреждает о несоответствии
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { ::operator delete(p); }
+
 
 TEST_CASE( "Initializing Constructors" ) {
   Resource a;
@@ -181,3 +206,463 @@ TEST_CASE("input table"){
   Resource test("tovar", 100, 200, 300);
   REQUIRE((t["tovar"]) == test);
 }
+
+TEST_CASE("hash index"){
+  Table t;
+  // вставки не по порядку имён: поиск не должен от него зависеть
+  const char *names[]{"tri", "odin", "pyat", "dva", "chetyre"};
+  uint price = 1;
+  for (const char *name : names)
+    t += Resource(name, price++);
+  for (uint i = 0; i < 5; i++)
+    REQUIRE(t[names[i]].getPrice() == i + 1);
+  REQUIRE_THROWS(t += Resource("odin", 10));
+
+  REQUIRE_NOTHROW(t.del_res("odin"));
+  REQUIRE_THROWS(t["odin"]);
+  REQUIRE(t["chetyre"].getPrice() == 5);
+  REQUIRE(t["tri"].getPrice() == 1);
+  REQUIRE_NOTHROW(t.del_res("chetyre"));
+  REQUIRE(t["dva"].getPrice() == 4);
+
+  REQUIRE(t.rename("dva", "two"));
+  REQUIRE_THROWS(t["dva"]);
+  REQUIRE(t["two"].getPrice() == 4);
+  REQUIRE_THROWS(t.rename("two", "tri"));
+
+  Table copy = t;
+  copy.del_res("two");
+  REQUIRE(t["two"].getPrice() == 4);
+  Table moved = std::move(copy);
+  REQUIRE_THROWS(moved["two"]);
+  REQUIRE(moved["pyat"].getPrice() == 3);
+
+  Resource dup[2]{Resource("a", 1), Resource("a", 2)};
+  REQUIRE_THROWS(Table(dup, 2));
+
+  // удаления и переименования вперемешку с добавлениями
+  Table many;
+  for (uint i = 0; i < 3000; i++)
+    many.emplace(std::to_string(i), 0, 0, i);
+  for (uint i = 0; i < 3000; i += 3)
+    many.del_res(std::to_string(i));
+  for (uint i = 1; i < 3000; i += 3)
+    many.rename(std::to_string(i), "r" + std::to_string(i));
+  auto has = [&many](const std::string &name){
+    try {
+      many[name];
+      return true;
+    }
+    catch(const std::runtime_error &){
+      return false;
+    }
+  };
+  bool found = true;
+  for (uint i = 0; i < 3000; i++){
+    std::string name = std::to_string(i);
+    if (i % 3 == 0)
+      found = found && !has(name);
+    else if (i % 3 == 1)
+      found = found && !has(name) && many["r" + name].getPrice() == i;
+    else
+      found = found && many[name].getPrice() == i;
+  }
+  REQUIRE(found);
+  REQUIRE(many.proffit() == 0);
+}
+
+TEST_CASE("sorted order"){
+  Table t;
+  t += Resource("c", 3);
+  t += Resource("a", 1);
+  t += Resource("d", 4);
+  t += Resource("b", 2);
+  std::stringstream out;
+  out << t;
+  REQUIRE(out.str() == "a consumption: 0 efficiency: 0 price: 1\n"
+                       "b consumption: 0 efficiency: 0 price: 2\n"
+                       "c consumption: 0 efficiency: 0 price: 3\n"
+                       "d consumption: 0 efficiency: 0 price: 4\n");
+
+  t.del_res("a");
+  t.rename("d", "0");
+  Resource more[3]{Resource("e", 5), Resource("bb", 6), Resource("aa", 7)};
+  t.insert(more, 3);
+  Resource clash[2]{Resource("f", 8), Resource("c", 9)};
+  REQUIRE_THROWS(t.insert(clash, 2));
+  Resource twice[2]{Resource("g", 8), Resource("g", 9)};
+  REQUIRE_THROWS(t.insert(twice, 2));
+  REQUIRE_THROWS(t["f"]);
+
+  std::string names;
+  std::stringstream listing;
+  listing << t;
+  for (std::string line; std::getline(listing, line);)
+    names += line.substr(0, line.find(' ')) + ",";
+  REQUIRE(names == "0,aa,b,bb,c,e,");
+  REQUIRE(t["bb"].getPrice() == 6);
+}
+
+TEST_CASE("sorted order after deletes"){
+  auto listing = [](Table &t){
+    std::stringstream out;
+    out << t;
+    std::string names;
+    for (std::string line; std::getline(out, line);)
+      names += line.substr(0, line.find(' ')) + ",";
+    return names;
+  };
+  Table t;
+  for (char c = 'a'; c <= 'h'; c++)
+    t += Resource(std::string(1, c), c);
+  // удаления оставляют пометки в порядке имён, вывод их пропускает
+  t.del_res("a");
+  t.del_res("d");
+  t.del_res("h");
+  REQUIRE(listing(t) == "b,c,e,f,g,");
+  Table copy(t);
+  REQUIRE(listing(copy) == "b,c,e,f,g,");
+  // переехавший на место удалённого ресурс удаляется по своему имени
+  t.del_res("g");
+  t.del_res("c");
+  REQUIRE(listing(t) == "b,e,f,");
+  t.rename("b", "z");
+  t += Resource("a", 1);
+  REQUIRE(listing(t) == "a,e,f,z,");
+  // удалений больше, чем ресурсов, и повторное заполнение
+  for (std::string n : {"a", "e", "f", "z"})
+    t.del_res(n);
+  REQUIRE(listing(t).empty());
+  Resource more[3]{Resource("y", 2), Resource("x", 3), Resource("w", 4)};
+  t.insert(more, 3);
+  t.del_res("x");
+  REQUIRE(listing(t) == "w,y,");
+  REQUIRE(t["y"].getPrice() == 2);
+  REQUIRE(listing(copy) == "b,c,e,f,g,");
+}
+
+TEST_CASE("lazy scale"){
+  Resource a[2]{Resource("a", 1, 3, 10), Resource("b", 2, 2, 5)};
+  Table t(a, 2);
+  t * 2;
+  t * 3;
+  REQUIRE(t.proffit() == 840);
+
+  Table copy = t;
+  REQUIRE(copy.proffit() == 840);
+  REQUIRE(ColumnTable(t).proffit() == 840);
+  REQUIRE(ColumnTable(t).get("a").getEffi() == 18);
+
+  // добавленный после умножения ресурс не умножается
+  t += Resource("c", 1, 2, 1);
+  REQUIRE(t.proffit() == 847);
+  t * 0.5;
+  std::stringstream out;
+  out << t;
+  REQUIRE(out.str() == "a consumption: 3 efficiency: 9 price: 10\n"
+                       "b consumption: 6 efficiency: 6 price: 5\n"
+                       "c consumption: 0.5 efficiency: 1 price: 1\n");
+
+  copy * 0;
+  REQUIRE(copy["a"].getCons() == 0);
+  REQUIRE(copy.proffit() == 0);
+  Table moved = std::move(t);
+  REQUIRE(moved["b"].getCons() == 6);
+  t += Resource("d", 1, 2, 1);
+  REQUIRE(t.proffit() == 7);
+}
+
+TEST_CASE("cached proffit"){
+  Resource a[3]{Resource("a", 1, 3, 10), Resource("b", 2, 2, 5), Resource("c", 4, 1, 2)};
+  Table t(a, 3);
+  REQUIRE(t.proffit() == 140 + 0 - 42);
+
+  t["b"].setEffi(3).setPrice(4);
+  REQUIRE(t.proffit() == 140 + 28 - 42);
+  t["c"].setName("d").setCons(1);
+  REQUIRE_THROWS(t["c"]);
+  REQUIRE(t["d"].getCons() == 1);
+  REQUIRE(t.proffit() == 140 + 28);
+  REQUIRE_THROWS(t["d"].setName("a"));
+
+  t * 2;
+  REQUIRE(t["a"].getEffi() == 6);
+  REQUIRE(t["a"].proffit() == 280);
+  t["a"].setCons(6);
+  REQUIRE(t.proffit() == 0 + 56);
+  Resource copy = t["b"];
+  REQUIRE(copy.getCons() == 4);
+  REQUIRE(copy.proffit() == 56);
+
+  t.del_res("b");
+  REQUIRE(t.proffit() == 0);
+  t += Resource("e", 1, 2, 3);
+  REQUIRE(t.proffit() == 21);
+  REQUIRE(Table(t).proffit() == 21);
+
+  // слагаемые разного порядка: малые не должны теряться рядом с большими
+  Table m;
+  m.emplace("big", 0, 1e15, 100);
+  m.emplace("small", 0, 1, 1);
+  m.del_res("big");
+  REQUIRE(m.proffit() == 7);
+  m.emplace("big", 0, 1e15, 100);
+  m["big"].setPrice(1);
+  m["big"].setEffi(0);
+  REQUIRE(m.proffit() == 7);
+  m.emplace("huge", 0, -1e15, 100);
+  m * 3;
+  m["huge"].setCons(0).setEffi(0);
+  REQUIRE(m.proffit() == 21);
+  REQUIRE(Table(m).proffit() == 21);
+}
+
+TEST_CASE("no redundant name copies"){
+  // длинные имена не помещаются в саму строку и всегда выделяют память
+  const uint n = 100;
+  std::vector<std::string> names, spare;
+  std::vector<Resource> rows;
+  rows.reserve(n);
+  for (uint i = 0; i < n; i++){
+    names.push_back(std::string(40, 'r') + std::to_string(i));
+    rows.emplace_back(names.back(), 1, 2, 3);
+  }
+  spare = names;
+
+  Table copied, emplaced, moved;
+  std::size_t before = allocations;
+  for (const Resource &r : rows)
+    copied += r;
+  std::size_t by_copy = allocations - before;
+
+  before = allocations;
+  for (uint i = 0; i < n; i++)
+    emplaced.emplace(std::move(spare[i]), 1, 2, 3);
+  std::size_t by_emplace = allocations - before;
+
+  before = allocations;
+  for (Resource &r : rows)
+    moved += std::move(r);
+  std::size_t by_move = allocations - before;
+
+  // рост таблиц одинаковый, разница - ровно по копии имени на ресурс
+  REQUIRE(by_copy - by_emplace == n);
+  REQUIRE(by_move == by_emplace);
+
+  // чтение имени и удаление ничего не копируют
+  before = allocations;
+  bool same = emplaced[names[7]].getName() == names[7] && &copied[names[7]].getName() == &copied[names[7]].getName();
+  emplaced.del_res(names[0]);
+  std::size_t by_lookup = allocations - before;
+  REQUIRE(same);
+  REQUIRE(by_lookup == 0);
+  REQUIRE(emplaced.proffit() == 7 * 3 * (n - 1));
+  REQUIRE_THROWS(emplaced.emplace(names[1], 0, 0, 0));
+}
+
+TEST_CASE("bulk load"){
+  std::istringstream in("\n3\nb 1 2.5 10\r\n\na\t-1 1e2 7\nc 0 0 0\n");
+  Table t;
+  t += Resource("0", 1, 2, 3);
+  t * 2;
+  t.load(in);
+  REQUIRE(in.eof());
+  REQUIRE_FALSE(in.fail());
+  REQUIRE(t["0"].getEffi() == 4);
+  REQUIRE(t["b"].getEffi() == 2.5);
+  REQUIRE(t["a"].getCons() == -1);
+  REQUIRE(t["a"].getPrice() == 7);
+  REQUIRE(t.proffit() == 42 + 105 + 7 * 101 * 7);
+
+  auto error = [](const std::string &text){
+    std::istringstream in(text);
+    Table t;
+    t += Resource("a", 3, 0, 1);
+    t * 0.1;
+    try {
+      t.load(in);
+    }
+    catch(const std::runtime_error &e){
+      // при ошибке ресурсы не меняются, и отложенный множитель не применён:
+      // 3 * 0.1 * 10 в double не равно 3, а 3 * (0.1 * 10) равно
+      t * 10;
+      REQUIRE(t.proffit() == -21);
+      REQUIRE_THROWS(t["x"]);
+      std::stringstream out;
+      out << t;
+      REQUIRE(out.str() == "a consumption: 3 efficiency: 0 price: 1\n");
+      REQUIRE(t["a"].getCons() == 3);
+      return std::string(e.what());
+    }
+    return std::string();
+  };
+  REQUIRE(error("2\nx 1 2 3\ny 1 2\n") == "Line 3: bad price");
+  REQUIRE(error("2\nx 1 2 3\n\ny one 2 3\n") == "Line 4: bad consumption");
+  REQUIRE(error("1\nx 1 2x 3\n") == "Line 2: bad efficiency");
+  REQUIRE(error("1\nx 1 2 -3\n") == "Line 2: bad price");
+  REQUIRE(error("1\nx 1 2 3 4\n") == "Line 2: unexpected data after price");
+  REQUIRE(error("1\nx 1 2 3\ny 1 2 3\n") == "Line 3: more than 1 resources");
+  REQUIRE(error("3\nx 1 2 3\n") == "Line 2: expected 3 resources, got 1");
+  REQUIRE(error("many\n") == "Line 1: bad resource count");
+  REQUIRE(error("\n") == "Empty input");
+  REQUIRE(error("2\nx 1 2 3\na 1 2 3\n") == "Resource already exists: a");
+  REQUIRE(error("4000000000\nx 1 2 3\n") == "Line 2: expected 4000000000 resources, got 1");
+
+  // оператор >> читает ровно заявленное число строк
+  std::istringstream two("1\nx 1 2 3\n2\ny 1 2 3\n\nz 2 2 2\n1\nw 1 2\n");
+  Table u;
+  two >> u >> u;
+  REQUIRE(u["x"].getPrice() == 3);
+  REQUIRE(u["z"].getCons() == 2);
+  try {
+    two >> u;
+    FAIL();
+  }
+  catch(const std::runtime_error &e){
+    REQUIRE(std::string(e.what()) == "Line 2: bad price");
+  }
+  REQUIRE_THROWS(u["w"]);
+
+  auto read_error = [](const std::string &text){
+    std::istringstream in(text);
+    Table t;
+    try {
+      in >> t;
+    }
+    catch(const std::runtime_error &e){
+      REQUIRE(t.check_size() == Table::empty);
+      return std::string(e.what());
+    }
+    return std::string();
+  };
+  // после количества в строке ничего нет, как и в load()
+  REQUIRE(read_error("2 x 1 2 3\ny 1 2 3\nz 1 2 3\n") == "Line 1: unexpected data after resource count");
+  REQUIRE(read_error("\n\nmany\n") == "Line 3: bad resource count");
+  // заявленное количество не резервируется целиком
+  REQUIRE(read_error("4000000000\nx 1 2 3\n") == "Line 2: expected 4000000000 resources, got 1");
+  REQUIRE(read_error("50000000\nx 1 2 3\n") == "Line 2: expected 50000000 resources, got 1");
+
+  // массив растёт во время чтения, уже прочитанные строки сохраняются
+  std::string text = "\n5000\n";
+  for (uint i = 0; i < 5000; i++)
+    text += "r" + std::to_string(i) + " 0 1 " + std::to_string(i) + "\n";
+  std::istringstream many(text);
+  Table m;
+  m += Resource("a", 1);
+  many >> m;
+  REQUIRE(m["a"].getPrice() == 1);
+  REQUIRE(m["r0"].getPrice() == 0);
+  REQUIRE(m["r4999"].getPrice() == 4999);
+  REQUIRE(m.proffit() == 7.0 * 4999 * 5000 / 2);
+}
+
+TEST_CASE("column table"){
+  Resource r1("1", 100, 200, 100);
+  Resource r2("2", 200, 100, 100);
+  Resource r3("3", 300, 0, 4000000000u);
+  Resource a[3]{r2, r3, r1};
+  ColumnTable c(a, 3);
+  Table t(a, 3);
+  REQUIRE(c.getSize() == 3);
+  REQUIRE(c.proffit() == t.proffit());
+  REQUIRE(c.get("3").getPrice() == 4000000000u);
+  REQUIRE_THROWS(c.get("4"));
+
+  c * 2;
+  t * 2;
+  REQUIRE(c.proffit() == t.proffit());
+  REQUIRE(c.get("1").getEffi() == 400);
+
+  c += Resource("0", 1, 2, 3);
+  REQUIRE(c.get("0").getPrice() == 3);
+  REQUIRE_NOTHROW(c.del_res("2"));
+  REQUIRE_THROWS(c.del_res("2"));
+  Table back = c.toTable();
+  REQUIRE(back["0"].getCons() == 1);
+  REQUIRE(back["3"].getCons() == 600);
+  REQUIRE(ColumnTable(back).proffit() == c.proffit());
+
+  // имена уникальны, как в Table
+  REQUIRE_THROWS(c += Resource("0", 5, 6, 7));
+  REQUIRE(c.getSize() == 3);
+  REQUIRE(c.get("0").getPrice() == 3);
+  Resource dup[3]{r1, r2, Resource("1", 1, 1, 1)};
+  REQUIRE_THROWS(ColumnTable(dup, 3));
+  REQUIRE_THROWS(Table(dup, 3));
+}
+
+TEST_CASE("column table tails"){
+  // хвосты, не кратные ширине вектора, на обоих путях: AVX2 (если есть) и SSE2
+  bool sse2 = GENERATE(false, true);
+  detail::force_sse2(sse2);
+  for (uint n = 0; n < 11; n++){
+    std::vector<Resource> rs;
+    for (uint i = 0; i < n; i++)
+      rs.emplace_back(std::to_string(i), i, 2.0 * i, i + 1);
+    ColumnTable c(rs.data(), n);
+    Table t(rs.data(), n);
+    REQUIRE(c.proffit() == t.proffit());
+    c * 3;
+    t * 3;
+    REQUIRE(c.proffit() == t.proffit());
+    for (uint i = 0; i < n; i++)
+      REQUIRE(c.get(std::to_string(i)).getEffi() == 6.0 * i);
+  }
+  detail::force_sse2(false);
+}
+
+TEST_CASE("table benchmarks", "[.][benchmark]"){
+  const uint n = 1000000;
+  std::vector<Resource> rs;
+  rs.reserve(n);
+  // 7919 простое и взаимно просто с n, поэтому имена - перестановка 0..n-1;
+  // произведение считается в 64 битах, в uint оно переполняется
+  for (uint i = 0; i < n; i++)
+    rs.emplace_back(std::to_string(std::uint64_t{i} * 7919 % n), 1.0 + i % 5, 2.0 + i % 7, i % 100);
+  Table t(rs.data(), n);
+
+  BENCHMARK("proffit 10^6"){
+    return t.proffit();
+  };
+  BENCHMARK("operator* 10^6"){
+    return &(t * 1.0);
+  };
+  BENCHMARK("_sort 10^6 (Table(Resource*, n))"){
+    return Table(rs.data(), n);
+  };
+
+  BENCHMARK("+= 10^5 one by one"){
+    Table one;
+    for (uint i = 0; i < 100000; i++)
+      one += rs[i];
+    return one.proffit();
+  };
+  BENCHMARK("insert 10^6 at once"){
+    Table bulk;
+    bulk.insert(rs.data(), n);
+    return bulk.proffit();
+  };
+
+  ColumnTable c(rs.data(), n);
+  std::string text = std::to_string(n) + "\n";
+  for (const Resource &r : rs)
+    text += r.getName() + " " + std::to_string(r.getCons()) + " " + std::to_string(r.getEffi()) + " " + std::to_string(r.getPrice()) + "\n";
+  BENCHMARK("load 10^6"){
+    std::istringstream in(text);
+    Table loaded;
+    loaded.load(in);
+    return loaded.proffit();
+  };
+  BENCHMARK("operator>> 10^6"){
+    std::istringstream in(text);
+    Table loaded;
+    in >> loaded;
+    return loaded.proffit();
+  };
+  BENCHMARK("ColumnTable proffit 10^6"){
+    return c.proffit();
+  };
+  BENCHMARK("ColumnTable operator* 10^6"){
+    return &(c * 1.0);
+  };
+}